@@ -0,0 +1,52 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+// define a block of the arena, the pieces are carved one after another out of data
+typedef struct Arena_Block {
+    struct Arena_Block *next; // point to the block filled before this one
+    size_t used;
+    size_t size;
+    Arena_Unit data[];
+} Arena_Block;
+
+void arena_init (Arena *A) {
+    A->blocks = NULL;
+}
+
+void arena_destroy (Arena *A) {
+    Arena_Block *b = A->blocks;
+    while (b) {
+        Arena_Block *temp = b;
+        b = b->next;
+        free(temp);
+    }
+    A->blocks = NULL;
+}
+
+void *arena_carve (Arena *A, size_t size) {
+    Arena_Block *b = A->blocks;
+    if (!b || b->size - b->used < size) {
+        // anything larger than a block gets a block of its own
+        size_t block_size = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        b = malloc(sizeof(*b) + block_size);
+        if (!b) return NULL;
+        b->used = 0;
+        b->size = block_size;
+        b->next = A->blocks;
+        A->blocks = b;
+    }
+    void *piece = (char *) b->data + b->used;
+    b->used += size;
+    return piece;
+}
+
+string arena_copy (Arena *A, const char *s, size_t len) {
+    string copy = arena_carve(A, len + 1);
+    if (!copy) return NULL;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
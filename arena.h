@@ -0,0 +1,50 @@
+#ifndef T_STRING
+#define T_STRING
+
+typedef char *string;
+
+#endif // T_STRING
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+// the alignment of every block, a run of items whose sizes are multiples of it stays aligned for any of them
+typedef union Arena_Unit { double d; void *p; size_t s; } Arena_Unit;
+
+/**
+ * A bump-pointer arena: memory is carved one piece after another out of large blocks,
+ * and is never given back piece by piece, only all at once when the arena is destroyed.
+ * It is kept by value inside the structure that owns it, so an empty arena costs no allocation.
+ */
+typedef struct Arena {
+    struct Arena_Block *blocks; // the block being filled, in front of the full ones
+} Arena;
+
+/**
+ * arena_init
+ * prepare an empty arena
+ */
+void arena_init (Arena *A);
+/**
+ * arena_destroy
+ * free every block of the arena, along with everything carved out of it
+ */
+void arena_destroy (Arena *A);
+/**
+ * arena_carve
+ * return size bytes carved out of the arena, which stay valid until it is destroyed
+ * return NULL on error
+ */
+void *arena_carve (Arena *A, size_t size);
+/**
+ * arena_copy
+ * copy the len bytes at s and a null terminator into the arena
+ * return the copy, NULL on error
+ */
+string arena_copy (Arena *A, const char *s, size_t len);
+
+#endif // ARENA_H
@@ -0,0 +1,464 @@
+/**
+ * Micro benchmarks for the crawler and rankings data structures
+ *
+ * Usage: ./bench <benchmark> [<args>]
+ *
+ * Each benchmark prints one line per configuration, with the timings in nanoseconds per operation.
+ *
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <libxml/parser.h>
+#include <libxml/xmlmemory.h>
+
+#include "list.h"
+#include "intern.h"
+#include "links.h"
+#include "graph.h"
+#include "csr.h"
+#include "dijkstra.h"
+
+#define URL_SIZE 96
+
+double now (void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+void make_url (char *buf, size_t i) {
+    snprintf(buf, URL_SIZE, "https://www.cse.unsw.edu.au/~cs9024/page%zu.html", i);
+}
+
+// visited-set lookups: list_contains against the marks of an intern pool, half of the probes are hits
+int bench_set (void) {
+    size_t sizes[] = {10000, 100000, 1000000};
+    size_t list_probes = 200;
+    size_t set_probes = 1000000;
+    char url[URL_SIZE];
+
+    printf("%10s %14s %14s %14s %10s\n", "urls", "set add ns", "list probe ns", "set probe ns", "hit rate");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+        size_t n = sizes[s];
+        list L = list_create();
+        intern_pool P = intern_create();
+
+        double start = now();
+        for (size_t i = 0; i < n; i++) {
+            make_url(url, i);
+            intern_mark(P, intern_add(P, url, strlen(url)));
+        }
+        double set_add = (now() - start) / n;
+        for (size_t i = 0; i < n; i++) {
+            make_url(url, i);
+            list_enqueue(L, url);
+        }
+
+        size_t list_hits = 0, set_hits = 0;
+        start = now();
+        for (size_t i = 0; i < list_probes; i++) {
+            make_url(url, (i * 7919) % (2 * n));
+            list_hits += list_contains(L, url);
+        }
+        double list_probe = (now() - start) / list_probes;
+        start = now();
+        for (size_t i = 0; i < set_probes; i++) {
+            make_url(url, (i * 7919) % (2 * n));
+            size_t id = intern_find(P, url, strlen(url));
+            set_hits += id != INTERN_NONE && intern_marked(P, id);
+        }
+        double set_probe = (now() - start) / set_probes;
+
+        printf("%10zu %14.1f %14.1f %14.1f %4zu%%/%3zu%%\n", n, set_add, list_probe, set_probe,
+               100 * list_hits / list_probes, 100 * set_hits / set_probes);
+        list_destroy(L);
+        intern_destroy(P);
+    }
+    return EXIT_SUCCESS;
+}
+
+// libxml2 allocator hooks which track the live and peak heap usage of the parser
+typedef struct xml_usage {
+    size_t live;
+    size_t peak;
+} xml_usage;
+
+xml_usage usage;
+
+#define HEADER_SIZE 16
+
+void *counting_malloc (size_t size) {
+    char *p = malloc(size + HEADER_SIZE);
+    if (!p) return NULL;
+    *(size_t *) p = size;
+    usage.live += size;
+    if (usage.live > usage.peak) usage.peak = usage.live;
+    return p + HEADER_SIZE;
+}
+
+void counting_free (void *ptr) {
+    if (!ptr) return;
+    char *p = (char *) ptr - HEADER_SIZE;
+    usage.live -= *(size_t *) p;
+    free(p);
+}
+
+void *counting_realloc (void *ptr, size_t size) {
+    if (!ptr) return counting_malloc(size);
+    char *p = (char *) ptr - HEADER_SIZE;
+    size_t old = *(size_t *) p;
+    p = realloc(p, size + HEADER_SIZE);
+    if (!p) return NULL;
+    *(size_t *) p = size;
+    usage.live = usage.live - old + size;
+    if (usage.live > usage.peak) usage.peak = usage.live;
+    return p + HEADER_SIZE;
+}
+
+char *counting_strdup (const char *str) {
+    size_t len = strlen(str) + 1;
+    char *p = counting_malloc(len);
+    if (p) memcpy(p, str, len);
+    return p;
+}
+
+// the hrefs reported for one document, in order
+typedef struct href_log {
+    char **hrefs;
+    size_t n;
+    size_t capacity;
+} href_log;
+
+void log_href (string href, void *ctx) {
+    href_log *log = ctx;
+    if (!log) return;
+    if (log->n == log->capacity) {
+        log->capacity = log->capacity ? log->capacity * 2 : 16;
+        log->hrefs = realloc(log->hrefs, log->capacity * sizeof(*log->hrefs));
+    }
+    log->hrefs[log->n++] = strdup(href);
+}
+
+void free_log (href_log *log) {
+    for (size_t i = 0; i < log->n; i++) {
+        free(log->hrefs[i]);
+    }
+    free(log->hrefs);
+    log->hrefs = NULL;
+    log->n = log->capacity = 0;
+}
+
+// link extraction over a corpus of saved pages: DOM + XPath against the streaming SAX scan
+int bench_links (int n_files, char **files) {
+    if (n_files < 1) {
+        fprintf(stderr, "Usage: bench links <page.html>...\n");
+        return EXIT_FAILURE;
+    }
+    xmlMemSetup(counting_free, counting_malloc, counting_realloc, counting_strdup);
+    xmlInitParser();
+
+    char **bufs = malloc(n_files * sizeof(*bufs));
+    size_t *sizes = malloc(n_files * sizeof(*sizes));
+    size_t total = 0;
+    for (int i = 0; i < n_files; i++) {
+        FILE *f = fopen(files[i], "rb");
+        if (!f) {
+            fprintf(stderr, "cannot open %s\n", files[i]);
+            return EXIT_FAILURE;
+        }
+        fseek(f, 0, SEEK_END);
+        sizes[i] = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        bufs[i] = malloc(sizes[i] + 1);
+        sizes[i] = fread(bufs[i], 1, sizes[i], f);
+        fclose(f);
+        total += sizes[i];
+    }
+
+    // check both modes report the same hrefs in the same order
+    size_t mismatches = 0, n_links = 0;
+    for (int i = 0; i < n_files; i++) {
+        href_log a = {0}, b = {0};
+        links_extract_xpath(bufs[i], sizes[i], files[i], log_href, &a);
+        links_extract_stream(bufs[i], sizes[i], files[i], log_href, &b);
+        bool same = a.n == b.n;
+        for (size_t j = 0; same && j < a.n; j++) {
+            same = strcmp(a.hrefs[j], b.hrefs[j]) == 0;
+        }
+        if (!same) {
+            fprintf(stderr, "link sets differ: %s (%zu vs %zu hrefs)\n", files[i], a.n, b.n);
+            mismatches++;
+        }
+        n_links += a.n;
+        free_log(&a);
+        free_log(&b);
+    }
+
+    size_t reps = 1 + (64 << 20) / (total + 1);
+    printf("%zu pages, %zu bytes, %zu hrefs, %zu mismatches, %zu repetitions\n",
+           (size_t) n_files, total, n_links, mismatches, reps);
+    printf("%8s %12s %12s %14s\n", "mode", "ms/corpus", "MB/s", "peak heap KB");
+    for (int mode = 0; mode < 2; mode++) {
+        usage.peak = usage.live;
+        size_t base = usage.live;
+        double start = now();
+        for (size_t r = 0; r < reps; r++) {
+            for (int i = 0; i < n_files; i++) {
+                if (mode == 0) {
+                    links_extract_xpath(bufs[i], sizes[i], files[i], log_href, NULL);
+                } else {
+                    links_extract_stream(bufs[i], sizes[i], files[i], log_href, NULL);
+                }
+            }
+        }
+        double elapsed = now() - start;
+        printf("%8s %12.3f %12.1f %14.1f\n", mode == 0 ? "xpath" : "stream",
+               elapsed / reps / 1e6, (double) total * reps / (elapsed / 1e9) / (1 << 20),
+               (usage.peak - base) / 1024.0);
+    }
+
+    for (int i = 0; i < n_files; i++) {
+        free(bufs[i]);
+    }
+    free(bufs);
+    free(sizes);
+    xmlCleanupParser();
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// a fixed pseudo random sequence, so every run ranks the same graph
+size_t next_random (uint64_t *state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *state >> 33;
+}
+
+// This function is to build a graph of n_vertices urls and about n_edges links, with the targets skewed towards the first pages
+graph make_graph (size_t n_vertices, size_t n_edges) {
+    char from[URL_SIZE], to[URL_SIZE];
+    uint64_t state = 9024;
+    graph G = graph_create();
+    for (size_t i = 0; i < n_vertices; i++) {
+        make_url(from, i);
+        graph_add_vertex(G, from);
+    }
+    for (size_t i = 0; i < n_edges; i++) {
+        // squaring skews the targets towards the first pages, the way a few pages collect most links
+        size_t r = next_random(&state) % n_vertices;
+        size_t target = (size_t) ((double) r * r / n_vertices);
+        make_url(from, next_random(&state) % n_vertices);
+        make_url(to, target);
+        graph_add_edge(G, from, to, 1 + next_random(&state) % 5);
+    }
+    return G;
+}
+
+// PageRank scaling: the serial kernel against the threaded one on 1, 2, 4 and 8 threads over the same snapshot
+int bench_pagerank (int argc, char **argv) {
+    size_t n_vertices = argc >= 1 ? strtoul(argv[0], NULL, 10) : 200000;
+    size_t n_edges = argc >= 2 ? strtoul(argv[1], NULL, 10) : 2000000;
+    if (n_vertices < 2) {
+        fprintf(stderr, "need at least 2 vertices\n");
+        return EXIT_FAILURE;
+    }
+    size_t threads[] = {1, 2, 4, 8};
+    // the first convergence test compares 1/N against zero, so delta has to stay well below 1/N to iterate at all
+    double delta = 1e-12;
+
+    graph G = make_graph(n_vertices, n_edges);
+    csr C = graph_freeze(G);
+    graph_destroy(G);
+
+    double *expected = malloc(C->nV * sizeof(double));
+    double *ranks = malloc(C->nV * sizeof(double));
+    double start = now();
+    csr_pagerank(C, .85, delta, expected);
+    double serial = now() - start;
+
+    printf("%zu vertices, %zu edges\n", C->nV, C->nE);
+    printf("%10s %12s %10s %14s\n", "threads", "ms", "speedup", "max diff");
+    printf("%10s %12.1f %10.2f %14.3g\n", "serial", serial / 1e6, 1.0, 0.0);
+    for (size_t t = 0; t < sizeof(threads) / sizeof(*threads); t++) {
+        start = now();
+        csr_pagerank_parallel(C, .85, delta, ranks, threads[t]);
+        double elapsed = now() - start;
+        double max_diff = 0;
+        for (size_t v = 0; v < C->nV; v++) {
+            double diff = ranks[v] > expected[v] ? ranks[v] - expected[v] : expected[v] - ranks[v];
+            max_diff = diff > max_diff ? diff : max_diff;
+        }
+        printf("%10zu %12.1f %10.2f %14.3g\n", threads[t], elapsed / 1e6, serial / elapsed, max_diff);
+    }
+    free(expected);
+    free(ranks);
+    csr_destroy(C);
+    return EXIT_SUCCESS;
+}
+
+// graph_show throughput: the text dump of a graph written to /dev/null, and to a file so the page cache is involved
+int bench_show (int argc, char **argv) {
+    size_t n_vertices = argc >= 1 ? strtoul(argv[0], NULL, 10) : 200000;
+    size_t n_edges = argc >= 2 ? strtoul(argv[1], NULL, 10) : 2000000;
+    if (n_vertices < 2) {
+        fprintf(stderr, "need at least 2 vertices\n");
+        return EXIT_FAILURE;
+    }
+    graph G = make_graph(n_vertices, n_edges);
+    FILE *null = fopen("/dev/null", "w");
+    FILE *file = tmpfile();
+    if (!null || !file) {
+        perror("bench show");
+        return EXIT_FAILURE;
+    }
+    // the file is written first, /dev/null keeps no position so it is taken to receive as many bytes
+    string names[] = {"tmpfile", "/dev/null"};
+    FILE *files[] = {file, null};
+    double mb = 0;
+    printf("%zu vertices, about %zu edges\n", graph_vertices_count(G), n_edges);
+    printf("%10s %12s %12s %10s\n", "target", "MB", "ms", "MB/s");
+    for (size_t i = 0; i < 2; i++) {
+        double start = now();
+        graph_show(G, files[i]);
+        fflush(files[i]);
+        double elapsed = now() - start;
+        if (files[i] == file) mb = ftell(file) / 1e6;
+        printf("%10s %12.1f %12.1f %10.1f\n", names[i], mb, elapsed / 1e6, mb / (elapsed / 1e9));
+    }
+    fclose(null);
+    fclose(file);
+    graph_destroy(G);
+    return EXIT_SUCCESS;
+}
+
+// define a frontier node of the queue graph_shortest_path used to allocate for every vertex it reached
+typedef struct Queue_Node {
+    size_t vertex;
+    struct Queue_Node *next;
+} Queue_Node;
+
+// This function is to count the hops from source the way graph_shortest_path used to, with a malloc and a free per vertex
+void malloc_queue_hops (csr C, size_t source, size_t *dist, size_t *pred) {
+    for (size_t v = 0; v < C->nV; v++) {
+        dist[v] = SIZE_MAX;
+        pred[v] = C->nV;
+    }
+    dist[source] = 0;
+    Queue_Node *head = malloc(sizeof(*head)), *tail = head;
+    head->vertex = source;
+    head->next = NULL;
+    while (head) {
+        size_t u = head->vertex;
+        for (size_t i = C->out_offsets[u]; i < C->out_offsets[u + 1]; i++) {
+            size_t v = C->out_targets[i];
+            if (dist[v] == SIZE_MAX) {
+                dist[v] = dist[u] + 1;
+                pred[v] = u;
+                Queue_Node *new = malloc(sizeof(*new));
+                new->vertex = v;
+                new->next = NULL;
+                tail->next = new;
+                tail = new;
+            }
+        }
+        Queue_Node *temp = head;
+        head = head->next;
+        free(temp);
+    }
+}
+
+// hop count queries from the first page: a malloc per queued vertex against the preallocated frontier on the same snapshot,
+// then the weighted bucket queue search, and the graph level queries, the first of which also takes the graph's snapshot,
+// and last the point to point queries searching from both ends, to random destinations
+int bench_paths (int argc, char **argv) {
+    size_t n_vertices = argc >= 1 ? strtoul(argv[0], NULL, 10) : 1000000;
+    size_t n_edges = argc >= 2 ? strtoul(argv[1], NULL, 10) : 10000000;
+    if (n_vertices < 2) {
+        fprintf(stderr, "need at least 2 vertices\n");
+        return EXIT_FAILURE;
+    }
+    size_t reps = 5;
+    graph G = make_graph(n_vertices, n_edges);
+    csr C = graph_freeze(G);
+    size_t *expected = malloc(C->nV * sizeof(size_t));
+    size_t *dist = malloc(C->nV * sizeof(size_t));
+    size_t *pred = malloc(C->nV * sizeof(size_t));
+    // make_graph adds the pages in order, so the first page is vertex 0 of the snapshot
+    char source[URL_SIZE];
+    make_url(source, 0);
+    // the point to point searches run on a query of their own, so the length of each path can be checked
+    path_query Q = path_query_create(G);
+
+    string names[] = {"malloc", "frontier", "dial", "first", "hops", "weighted", "hops to", "weighted to"};
+    size_t to_reps = 100;
+    uint64_t state = 2024;
+    printf("%zu vertices, %zu edges\n", C->nV, C->nE);
+    printf("%12s %12s %12s\n", "search", "ms", "reached");
+    for (size_t m = 0; m < sizeof(names) / sizeof(*names); m++) {
+        double start = now();
+        size_t runs = m == 3 ? 1 : m >= 6 ? to_reps : reps;
+        size_t mismatches = 0;
+        for (size_t r = 0; r < runs; r++) {
+            char destination[URL_SIZE];
+            size_t target = m >= 6 ? next_random(&state) % n_vertices : 0;
+            if (m >= 6) make_url(destination, target);
+            if (m == 0) malloc_queue_hops(C, 0, expected, pred);
+            if (m == 1) csr_shortest_path(C, 0, dist, pred);
+            if (m == 2) csr_dijkstra(C, 0, dist, pred);
+            if (m == 3 || m == 4) graph_shortest_hops(G, source);
+            if (m == 5) graph_shortest_path(G, source);
+            if (m == 6) path_query_hops_to(Q, source, destination);
+            if (m == 7) path_query_shortest_to(Q, source, destination);
+            // the full searches above, from the same source, left the hops in expected and the weights in dist
+            if (m >= 6) mismatches += path_query_distance(Q, destination) != (m == 6 ? expected : dist)[target];
+        }
+        double elapsed = (now() - start) / runs;
+        // the graph level queries keep their results in the graph, so only the snapshot searches report a count
+        size_t reached = 0;
+        for (size_t v = 0; m < 3 && v < C->nV; v++) {
+            reached += (m == 0 ? expected[v] : dist[v]) != SIZE_MAX;
+        }
+        if (m == 1 && memcmp(dist, expected, C->nV * sizeof(size_t)) != 0) {
+            fprintf(stderr, "the frontier search disagrees with the malloc queue\n");
+            return EXIT_FAILURE;
+        }
+        if (mismatches) {
+            fprintf(stderr, "the %s search disagrees with the full search on %zu of %zu paths\n", names[m], mismatches, runs);
+            return EXIT_FAILURE;
+        }
+        printf("%12s %12.2f %12zu\n", names[m], elapsed / 1e6, reached);
+    }
+    free(expected);
+    free(dist);
+    free(pred);
+    path_query_destroy(Q);
+    csr_destroy(C);
+    graph_destroy(G);
+    return EXIT_SUCCESS;
+}
+
+int main (int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "set") == 0) {
+        return bench_set();
+    }
+    if (argc >= 2 && strcmp(argv[1], "links") == 0) {
+        return bench_links(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "pagerank") == 0) {
+        return bench_pagerank(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "show") == 0) {
+        return bench_show(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "paths") == 0) {
+        return bench_paths(argc - 2, argv + 2);
+    }
+    fprintf(stderr, "Usage: %s set | links <page.html>... | pagerank [<vertices> [<edges>]] | show [<vertices> [<edges>]]"
+                    " | paths [<vertices> [<edges>]]\n", argv[0]);
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,364 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "cache.h"
+#include "graph.h"
+
+// the longest line the cache format allows, rankings has always read the cache with fgets into a BUFSIZ buffer
+#define CACHE_MAX_LINE (BUFSIZ - 1)
+#define CACHE_MAX_TOKENS 3
+// the parallel loader splits the file into chunks of about this size, and lets the workers run this many chunks per thread ahead of the merge
+#define CACHE_CHUNK_SIZE (8 * 1024 * 1024)
+#define CACHE_CHUNKS_AHEAD 2
+#define CACHE_INITIAL_RECORDS 1024
+
+// define a token as a span of the mapped file, which is not null terminated
+typedef struct Token {
+    const char *start;
+    size_t len;
+} Token;
+
+// define the outcome of parsing one line, everything but LINE_VERTEX and LINE_EDGE is a blank or malformed line
+typedef enum Line_Kind {
+    LINE_BLANK,
+    LINE_VERTEX,
+    LINE_EDGE,
+    LINE_TOO_LONG,
+    LINE_BAD_TOKENS,
+    LINE_BAD_WEIGHT,
+    LINE_NO_MEMORY,
+} Line_Kind;
+
+// define a parsed vertex or edge line, a vertex line only has from
+typedef struct Record {
+    Token from;
+    Token to;
+    size_t weight;
+} Record;
+
+// define a chunk of whole lines and the records a worker parsed from it
+typedef struct Chunk {
+    const char *start;
+    const char *end;
+    Record *records;
+    size_t n_records;
+    size_t capacity;
+    Line_Kind error; // LINE_BLANK unless the chunk has a malformed line, which ends its records
+    bool done;
+} Chunk;
+
+// define the state the workers and the merging thread share
+typedef struct Loader {
+    Chunk *chunks;
+    size_t n_chunks;
+    size_t next; // the next chunk a worker should parse
+    size_t merged; // the number of chunks merged into the graph so far
+    size_t ahead; // how many chunks past the merged ones may be parsed
+    bool failed;
+    pthread_mutex_t lock;
+    pthread_cond_t parsed; // signalled when a chunk is done
+    pthread_cond_t consumed; // signalled when a chunk is merged, or the load fails
+} Loader;
+
+bool is_separator (char c) {
+    return c == ' ' || c == '\t' || c == '\n';
+}
+
+// This function is to parse a weight the way strtol does, all of the token has to be an optional sign and digits.
+bool parse_weight (Token tok, size_t *weight) {
+    size_t i = 0;
+    bool negative = false;
+    if (tok.start[i] == '+' || tok.start[i] == '-') {
+        negative = tok.start[i] == '-';
+        i++;
+    }
+    if (i == tok.len) return false;
+    size_t value = 0;
+    for (; i < tok.len; i++) {
+        if (tok.start[i] < '0' || tok.start[i] > '9') return false;
+        value = value * 10 + (tok.start[i] - '0');
+    }
+    *weight = negative ? -value : value;
+    return true;
+}
+
+// This function is to split one line, which ends at end, into a record.
+Line_Kind cache_parse_line (const char *line, const char *end, Record *record) {
+    Token toks[CACHE_MAX_TOKENS];
+    size_t n_tok = 0;
+    const char *p = line;
+    while (p < end) {
+        while (p < end && is_separator(*p)) p++;
+        if (p == end) break;
+        const char *start = p;
+        while (p < end && !is_separator(*p)) p++;
+        if (n_tok == CACHE_MAX_TOKENS) return LINE_BAD_TOKENS;
+        toks[n_tok++] = (Token) { start, p - start };
+    }
+    switch (n_tok) {
+        case 0: {
+            return LINE_BLANK;
+        }
+        case 1: {
+            record->from = toks[0];
+            return LINE_VERTEX;
+        }
+        case 3: {
+            if (!parse_weight(toks[2], &record->weight)) return LINE_BAD_WEIGHT;
+            record->from = toks[0];
+            record->to = toks[1];
+            return LINE_EDGE;
+        }
+        default: {
+            return LINE_BAD_TOKENS;
+        }
+    }
+}
+
+// This function is to find the end of the line starting at line, false if it has no newline or would not fit the line buffer.
+bool cache_next_line (const char *line, const char *end, const char **newline) {
+    *newline = memchr(line, '\n', end - line);
+    return *newline && (size_t) (*newline - line) < CACHE_MAX_LINE;
+}
+
+void cache_report (Line_Kind kind) {
+    switch (kind) {
+        case LINE_TOO_LONG: {
+            fprintf(stderr, "Line to Long: aborting reading cache file.\n");
+            break;
+        }
+        case LINE_BAD_WEIGHT: {
+            fprintf(stderr, "weight is not numeric.\n");
+            break;
+        }
+        case LINE_BAD_TOKENS: {
+            fprintf(stderr, "Line has incorrect number of tokens.\n");
+            break;
+        }
+        case LINE_NO_MEMORY: {
+            fprintf(stderr, "Out of memory: aborting reading cache file.\n");
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+void cache_add_record (graph G, Record *record, Line_Kind kind) {
+    if (kind == LINE_VERTEX) {
+        graph_add_vertex_bytes(G, record->from.start, record->from.len);
+    } else {
+        graph_add_edge_bytes(G, record->from.start, record->from.len, record->to.start, record->to.len, record->weight);
+    }
+}
+
+// This function is to read the text cache in buf on the calling thread, false after reporting a malformed line.
+bool cache_load_text (graph G, const char *buf, size_t size) {
+    const char *line = buf, *end = buf + size;
+    while (line < end) {
+        const char *newline;
+        Record record;
+        Line_Kind kind = LINE_TOO_LONG;
+        if (cache_next_line(line, end, &newline)) {
+            kind = cache_parse_line(line, newline, &record);
+        }
+        if (kind == LINE_VERTEX || kind == LINE_EDGE) {
+            cache_add_record(G, &record, kind);
+        } else if (kind != LINE_BLANK) {
+            cache_report(kind);
+            return false;
+        }
+        line = newline + 1;
+    }
+    return true;
+}
+
+// This function is to parse every line of a chunk into its records, stopping at the first malformed line.
+void cache_parse_chunk (Chunk *chunk) {
+    const char *line = chunk->start;
+    while (line < chunk->end) {
+        const char *newline;
+        Line_Kind kind = LINE_TOO_LONG;
+        if (cache_next_line(line, chunk->end, &newline)) {
+            if (chunk->n_records == chunk->capacity) {
+                size_t capacity = chunk->capacity ? chunk->capacity * 2 : CACHE_INITIAL_RECORDS;
+                Record *records = realloc(chunk->records, capacity * sizeof(*records));
+                if (!records) {
+                    chunk->error = LINE_NO_MEMORY;
+                    return;
+                }
+                chunk->records = records;
+                chunk->capacity = capacity;
+            }
+            Record *record = &chunk->records[chunk->n_records];
+            record->to.start = NULL;
+            kind = cache_parse_line(line, newline, record);
+            if (kind == LINE_VERTEX || kind == LINE_EDGE) {
+                chunk->n_records++;
+            }
+        }
+        if (kind != LINE_BLANK && kind != LINE_VERTEX && kind != LINE_EDGE) {
+            chunk->error = kind;
+            return;
+        }
+        line = newline + 1;
+    }
+}
+
+void *cache_worker (void *arg) {
+    Loader *L = arg;
+    pthread_mutex_lock(&L->lock);
+    while (!L->failed && L->next < L->n_chunks) {
+        if (L->next >= L->merged + L->ahead) {
+            pthread_cond_wait(&L->consumed, &L->lock);
+            continue;
+        }
+        Chunk *chunk = &L->chunks[L->next++];
+        pthread_mutex_unlock(&L->lock);
+        cache_parse_chunk(chunk);
+        pthread_mutex_lock(&L->lock);
+        chunk->done = true;
+        pthread_cond_broadcast(&L->parsed);
+    }
+    pthread_mutex_unlock(&L->lock);
+    return NULL;
+}
+
+// This function is to read the text cache in buf with n_threads workers parsing chunks while this thread merges them in file order.
+bool cache_load_parallel (graph G, const char *buf, size_t size, size_t n_threads) {
+    Loader L = { .ahead = CACHE_CHUNKS_AHEAD * n_threads };
+    L.n_chunks = size / CACHE_CHUNK_SIZE > n_threads ? size / CACHE_CHUNK_SIZE : n_threads;
+    L.chunks = calloc(L.n_chunks, sizeof(*L.chunks));
+    pthread_t *threads = malloc(n_threads * sizeof(*threads));
+    if (!L.chunks || !threads) {
+        free(L.chunks);
+        free(threads);
+        return cache_load_text(G, buf, size);
+    }
+    // every chunk but the first starts just after a newline, so no line is split between two of them
+    const char *start = buf, *end = buf + size;
+    for (size_t i = 0; i < L.n_chunks; i++) {
+        const char *split = buf + size / L.n_chunks * (i + 1);
+        if (i == L.n_chunks - 1 || split <= start) {
+            split = i == L.n_chunks - 1 ? end : start;
+        } else {
+            const char *newline = memchr(split - 1, '\n', end - (split - 1));
+            split = newline ? newline + 1 : end;
+        }
+        L.chunks[i].start = start;
+        L.chunks[i].end = split;
+        start = split;
+    }
+    pthread_mutex_init(&L.lock, NULL);
+    pthread_cond_init(&L.parsed, NULL);
+    pthread_cond_init(&L.consumed, NULL);
+    size_t started = 0;
+    for (; started < n_threads; started++) {
+        if (pthread_create(&threads[started], NULL, cache_worker, &L) != 0) break;
+    }
+    if (!started) {
+        pthread_cond_destroy(&L.consumed);
+        pthread_cond_destroy(&L.parsed);
+        pthread_mutex_destroy(&L.lock);
+        free(L.chunks);
+        free(threads);
+        return cache_load_text(G, buf, size);
+    }
+
+    bool ok = true;
+    for (size_t i = 0; ok && i < L.n_chunks; i++) {
+        Chunk *chunk = &L.chunks[i];
+        pthread_mutex_lock(&L.lock);
+        while (!chunk->done) {
+            pthread_cond_wait(&L.parsed, &L.lock);
+        }
+        pthread_mutex_unlock(&L.lock);
+        for (size_t r = 0; r < chunk->n_records; r++) {
+            Record *record = &chunk->records[r];
+            cache_add_record(G, record, record->to.start ? LINE_EDGE : LINE_VERTEX);
+        }
+        free(chunk->records);
+        chunk->records = NULL;
+        if (chunk->error != LINE_BLANK) {
+            // the first malformed line of the file is the one reported, as later chunks are never looked at
+            cache_report(chunk->error);
+            ok = false;
+        }
+        pthread_mutex_lock(&L.lock);
+        L.merged = i + 1;
+        L.failed = !ok;
+        pthread_cond_broadcast(&L.consumed);
+        pthread_mutex_unlock(&L.lock);
+    }
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (size_t i = 0; i < L.n_chunks; i++) {
+        free(L.chunks[i].records);
+    }
+    pthread_cond_destroy(&L.consumed);
+    pthread_cond_destroy(&L.parsed);
+    pthread_mutex_destroy(&L.lock);
+    free(L.chunks);
+    free(threads);
+    return ok;
+}
+
+graph cache_load (string path, size_t n_threads) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return graph_create();
+    }
+    size_t size = st.st_size;
+    const char *buf = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (buf == MAP_FAILED) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    // the file is read front to back once, so let the kernel read ahead aggressively
+    madvise((void *) buf, size, MADV_SEQUENTIAL);
+
+    if (graph_is_snapshot(buf, size)) {
+        graph network = graph_read_snapshot(buf, size);
+        munmap((void *) buf, size);
+        if (!network) {
+            fprintf(stderr, "%s: snapshot is corrupt or truncated.\n", path);
+        }
+        return network;
+    }
+
+    graph network = graph_create();
+    if (!network) {
+        munmap((void *) buf, size);
+        return NULL;
+    }
+    bool ok = n_threads > 1 ? cache_load_parallel(network, buf, size, n_threads) : cache_load_text(network, buf, size);
+    munmap((void *) buf, size);
+    if (!ok) {
+        graph_destroy(network);
+        return NULL;
+    }
+    return network;
+}
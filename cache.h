@@ -0,0 +1,24 @@
+#ifndef T_STRING
+#define T_STRING
+
+typedef char *string;
+
+#endif // T_STRING
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "graph.h"
+
+/**
+ * cache_load
+ * read a cache file in the format written by graph_show, or a snapshot written by graph_save, into a new graph
+ * the file is mapped into memory, a snapshot is recognised by its magic number and anything else read as text
+ * text is parsed in place, one line at a time without copying it, and blank lines are skipped
+ * with more than one thread, text is split into chunks of whole lines that n_threads workers parse
+ * while the calling thread adds them to the graph in file order, so the graph is the same as with one
+ * return NULL, after printing the reason to stderr, if the file cannot be read or a line is malformed
+ */
+graph cache_load (string path, size_t n_threads);
+
+#endif // CACHE_H
@@ -13,187 +13,431 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stddef.h>
-#include <time.h>
+#include <unistd.h>
 
 #include <curl/curl.h>
-#include <libxml/HTMLparser.h>
-#include <libxml/xpath.h>
+#include <libxml/parser.h>
 #include <libxml/uri.h>
 
-#include "list.h"
 #include "graph.h"
 #include "pagerank.h"
 #include "dijkstra.h"
+#include "politeness.h"
+#include "intern.h"
+#include "links.h"
+#include "writer.h"
 
-/* resizable buffer */
+/* resizable buffer, grown geometrically */
 typedef struct memory {
     char *buf;
     size_t size;
+    size_t capacity;
 } memory;
 
+/* the page whose links are being extracted */
+typedef struct page {
+    scheduler queue;
+    intern_pool urls; // every url seen, with the ones already queued marked
+    graph network;
+    string url; // the effective url, which relative links are resolved against
+    size_t base_url; // the pool id of the url as it was queued
+} page;
+
+/* in-flight transfer */
+typedef struct transfer {
+    string url; // the url as it was queued, before any redirects
+    memory mem;
+    CURL *handle;
+    page p; // where links found while the body is still arriving are recorded
+    link_parser parser; // scans the body as it arrives, when parsing incrementally
+    int body_checked; // whether the status and content type have been checked for incremental parsing
+} transfer;
+
+/* idle transfers kept for reuse with their easy handles and buffers, and the DNS and TLS session caches they share */
+typedef struct handle_pool {
+    CURLSH *share;
+    transfer **idle;
+    size_t n_idle;
+    size_t capacity;
+    size_t transfers; // the number of successful transfers
+    size_t reused; // the number of successful transfers which did not open a new connection
+} handle_pool;
+
+#define DEFAULT_MAX_TRANSFERS 8
+#define DEFAULT_HOST_DELAY_MS 500
+#define BUFFER_INITIAL_CAPACITY 16384
+#define BUFFER_MAX_POOLED (1 << 20) // larger buffers are freed rather than kept in the pool
+
+/* extract links by building the whole document tree and querying it, rather than streaming */
+int use_xpath = 0;
+/* scan each body for links while it is still downloading, rather than once it has completed */
+int incremental = 0;
+
 
 int    is_html     (string);
-graph  follow_link (string);
-void   find_links  (list, list, graph, memory *, string, string);
-CURL  *make_handle (string);
+graph  follow_link (string, intern_pool, long, long);
+void   find_links  (scheduler, intern_pool, graph, memory *, string, size_t);
+void   add_link    (string, void *);
+CURL  *make_handle (handle_pool *, size_t, page *);
+void   release_handle(handle_pool *, transfer *);
+int    reserve_buffer(memory *, size_t);
 size_t grow_buffer (void *, size_t, size_t, void *);
-void   add_or_increment_edge(graph, string, string);
+size_t receive_body(void *, size_t, size_t, void *);
+void   add_or_increment_edge(graph, size_t, size_t);
+void   view_paths  (graph, FILE *);
 
 int main(int argc, char **argv)
 {
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <url>\n", argv[0]);
+    long max_transfers = DEFAULT_MAX_TRANSFERS;
+    long host_delay = DEFAULT_HOST_DELAY_MS;
+    string snapshot_path = NULL;
+    string batch_path = NULL;
+    int hops = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "j:d:xis:Hb:")) != -1) {
+        switch (opt) {
+            case 'j': {
+                char *endptr = NULL;
+                max_transfers = strtol(optarg, &endptr, 10);
+                if (*endptr != '\0' || max_transfers < 1) {
+                    fprintf(stderr, "'%s' is not a positive integer\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+            case 'd': {
+                char *endptr = NULL;
+                host_delay = strtol(optarg, &endptr, 10);
+                if (*endptr != '\0' || host_delay < 0) {
+                    fprintf(stderr, "'%s' is not a non-negative integer\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+            case 'x': {
+                use_xpath = 1;
+                break;
+            }
+            case 'i': {
+                incremental = 1;
+                break;
+            }
+            case 's': {
+                snapshot_path = optarg;
+                break;
+            }
+            case 'H': {
+                hops = 1;
+                break;
+            }
+            case 'b': {
+                batch_path = optarg;
+                break;
+            }
+            default: {
+                fprintf(stderr, "Usage: %s [-j <max transfers>] [-d <host delay ms>] [-x | -i] [-s <snapshot file>] [-H] [-b <destinations file> | -b -] <url>\n", argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    if (argc - optind != 1) {
+        fprintf(stderr, "Usage: %s [-j <max transfers>] [-d <host delay ms>] [-x | -i] [-s <snapshot file>] [-H] [-b <destinations file> | -b -] <url>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (use_xpath && incremental) {
+        fprintf(stderr, "-x and -i cannot be combined, incremental parsing always streams\n");
         return EXIT_FAILURE;
     }
+    string seed = argv[optind];
 
     // attempt some form on normalisation by removing any queries or fragments
-    if (strchr(argv[1], '?')) *strchr(argv[1], '?') = '\0';
-    if (strchr(argv[1], '#')) *strchr(argv[1], '#') = '\0';
+    if (strchr(seed, '?')) *strchr(seed, '?') = '\0';
+    if (strchr(seed, '#')) *strchr(seed, '#') = '\0';
 
+    intern_pool urls = intern_create();
     graph network = NULL;
-    if (strstr(argv[1], "cse.unsw.edu.au") || strstr(argv[1], "localhost")) {
-        network = follow_link(argv[1]);
+    if (strstr(seed, "cse.unsw.edu.au") || strstr(seed, "localhost")) {
+        network = follow_link(seed, urls, max_transfers, host_delay);
     } else {
         fprintf(stderr, "refusing to touch non CSE pages.");
+        intern_destroy(urls);
         return EXIT_FAILURE;
     }
 
     graph_show(network, stdout);
-    graph_shortest_path(network, argv[1]);
-    char destination[BUFSIZ];
-    printf("destination: ");
-    fgets(destination, BUFSIZ, stdin);
-    destination[strlen(destination)-1] = '\0'; // trim '\n'
-    graph_view_path(network, destination);
+    if (snapshot_path) {
+        // the binary snapshot is written alongside the text graph, rankings reads either
+        FILE *snapshot = fopen(snapshot_path, "wb");
+        if (!snapshot || !graph_save(network, snapshot) || fclose(snapshot) != 0) {
+            perror(snapshot_path);
+        }
+    }
+    // -H counts the clicks to the destination, instead of summing the link counts along the path
+    if (batch_path) {
+        // every destination is answered from one search of the whole graph, - reads them from stdin
+        if (hops) {
+            graph_shortest_hops(network, seed);
+        } else {
+            graph_shortest_path(network, seed);
+        }
+        FILE *destinations = strcmp(batch_path, "-") == 0 ? stdin : fopen(batch_path, "r");
+        if (destinations) {
+            view_paths(network, destinations);
+            if (destinations != stdin) fclose(destinations);
+        } else {
+            perror(batch_path);
+        }
+    } else {
+        char destination[BUFSIZ];
+        printf("destination: ");
+        if (fgets(destination, BUFSIZ, stdin)) {
+            destination[strcspn(destination, "\n")] = '\0'; // trim '\n'
+            // a single destination is searched for from both ends, which stops long before the whole graph is explored
+            if (hops) {
+                graph_shortest_hops_to(network, seed, destination);
+            } else {
+                graph_shortest_path_to(network, seed, destination);
+            }
+            graph_view_path(network, destination);
+        }
+    }
     graph_destroy(network);
+    intern_destroy(urls);
 
     return EXIT_SUCCESS;
 }
 
-// webpage fetcher using libcurl
-graph follow_link(string base_url)
+// webpage fetcher using libcurl, keeping up to max_transfers fetches in flight at once
+// and starting fetches from the same host no closer than host_delay milliseconds apart
+graph follow_link(string base_url, intern_pool urls, long max_transfers, long host_delay)
 {
     curl_global_init(CURL_GLOBAL_ALL);
-    list queue    = list_create();
-    list visited  = list_create();
-    graph network = graph_create();
-    list_enqueue(queue, base_url);
-    list_add(visited, base_url);
-    while (!list_is_empty(queue)) {
-        char *url, *ctype;
-        memory *mem;
-        base_url = list_dequeue(queue);
-        CURL *handle = make_handle(base_url);
-        CURLcode res = curl_easy_perform(handle);
-        nanosleep(&(struct timespec){.tv_sec = 0, .tv_nsec = 500000000}, NULL);
-        curl_easy_getinfo(handle, CURLINFO_CONTENT_TYPE, &ctype);
-        curl_easy_getinfo(handle, CURLINFO_PRIVATE, &mem);
-        curl_easy_getinfo(handle, CURLINFO_EFFECTIVE_URL, &url);
-
-        if (res == CURLE_OK) {
-            long res_status;
-            curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &res_status);
-            if (res_status == 200) {
-                printf("HTTP 200: %s\n", base_url);
-                if (is_html(ctype)) {
-                    find_links(queue, visited, network, mem, url, base_url);
+    CURLM *multi    = curl_multi_init();
+    handle_pool pool = {
+        .share = curl_share_init(),
+        .idle = malloc(max_transfers * sizeof(transfer *)),
+        .n_idle = 0,
+        .capacity = max_transfers,
+    };
+    curl_share_setopt(pool.share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(pool.share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    // the queue, the visited marks and the graph all share the one copy of each url in the pool
+    scheduler queue = scheduler_create(host_delay, urls);
+    graph network   = graph_create_interned(urls);
+    size_t seed = intern_add(urls, base_url, strlen(base_url));
+    if (seed == INTERN_NONE || !scheduler_enqueue(queue, seed)) {
+        fprintf(stderr, "Out of memory, skipping: %s\n", base_url);
+    } else {
+        intern_mark(urls, seed);
+    }
+    page crawl = {queue, urls, network, NULL, INTERN_NONE};
+    curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, max_transfers);
+
+    long pending = 0;
+    while (!scheduler_is_empty(queue) || pending) {
+        // top up the in-flight transfers from whichever hosts are ready
+        size_t next;
+        while (pending < max_transfers && (next = scheduler_dequeue(queue)) != INTERN_NONE) {
+            curl_multi_add_handle(multi, make_handle(&pool, next, &crawl));
+            pending++;
+        }
+
+        int still_running = 0;
+        curl_multi_perform(multi, &still_running);
+
+        CURLMsg *m = NULL;
+        int msgs_left = 0;
+        while ((m = curl_multi_info_read(multi, &msgs_left))) {
+            if (m->msg != CURLMSG_DONE) continue;
+            char *url, *ctype;
+            transfer *t;
+            CURL *handle = m->easy_handle;
+            CURLcode res = m->data.result;
+            curl_easy_getinfo(handle, CURLINFO_CONTENT_TYPE, &ctype);
+            curl_easy_getinfo(handle, CURLINFO_PRIVATE, &t);
+            curl_easy_getinfo(handle, CURLINFO_EFFECTIVE_URL, &url);
+
+            if (res == CURLE_OK) {
+                long connects = 0;
+                curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+                pool.transfers++;
+                if (!connects) pool.reused++;
+                long res_status;
+                curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &res_status);
+                if (res_status == 200) {
+                    printf("HTTP 200: %s\n", t->url);
+                    if (t->parser) {
+                        link_parser_finish(t->parser);
+                        t->parser = NULL;
+                    } else if (!incremental && is_html(ctype)) {
+                        find_links(queue, urls, network, &t->mem, url, t->p.base_url);
+                    }
+                } else {
+                    fprintf(stderr, "HTTP %d: %s\n", (int)res_status, t->url);
                 }
             } else {
-                fprintf(stderr, "HTTP %d: %s\n", (int)res_status, base_url);
+                fprintf(stderr, "Connection failure: %s\n", t->url);
             }
-        } else {
-            fprintf(stderr, "Connection failure: %s\n", base_url);
+
+            curl_multi_remove_handle(multi, handle);
+            if (t->parser) link_parser_finish(t->parser);
+            free(t->p.url);
+            release_handle(&pool, t);
+            pending--;
         }
 
-        free(base_url);
-        free(mem->buf);
-        free(mem);
-        curl_easy_cleanup(handle);
+        // sleep until a transfer needs attention or a host becomes ready
+        if (pending || !scheduler_is_empty(queue)) {
+            long timeout = scheduler_wait_ms(queue);
+            if (timeout < 0 || timeout > 1000 || pending >= max_transfers) timeout = 1000;
+            curl_multi_poll(multi, NULL, 0, (int) timeout, NULL);
+        }
     }
 
-    list_destroy(queue);
-    list_destroy(visited);
+    if (pool.transfers) {
+        fprintf(stderr, "Connections reused: %zu/%zu transfers (%.1f%%)\n",
+                pool.reused, pool.transfers, 100.0 * pool.reused / pool.transfers);
+    }
+    while (pool.n_idle) {
+        transfer *t = pool.idle[--pool.n_idle];
+        curl_easy_cleanup(t->handle);
+        free(t->mem.buf);
+        free(t);
+    }
+    free(pool.idle);
+    scheduler_destroy(queue);
+    curl_multi_cleanup(multi);
+    curl_share_cleanup(pool.share);
     curl_global_cleanup();
     xmlCleanupParser();
     return network;
 }
 
 // HREF finder using libxml2
-void find_links(list queue, list visited, graph network, memory *mem, string url, string base_url)
+void find_links(scheduler queue, intern_pool urls, graph network, memory *mem, string url, size_t base_url)
 {
-    int opts = HTML_PARSE_NOBLANKS | HTML_PARSE_NOERROR | HTML_PARSE_NOWARNING | HTML_PARSE_NONET;
-    htmlDocPtr doc = htmlReadMemory(mem->buf, (int)mem->size, url, NULL, opts);
-    if (!doc) return;
-
-    xmlChar *xpath = (xmlChar*) "//a/@href";
-    xmlXPathContextPtr context = xmlXPathNewContext(doc);
-    xmlXPathObjectPtr result = xmlXPathEvalExpression(xpath, context);
-    xmlXPathFreeContext(context);
-    if (!result) {
-        xmlFreeDoc(doc);
-        return;
-    }
-    xmlNodeSetPtr nodeset = result->nodesetval;
-    if (xmlXPathNodeSetIsEmpty(nodeset)) {
-        xmlXPathFreeObject(result);
-        xmlFreeDoc(doc);
-        return;
+    page p = {queue, urls, network, url, base_url};
+    if (use_xpath) {
+        links_extract_xpath(mem->buf, mem->size, url, add_link, &p);
+    } else {
+        links_extract_stream(mem->buf, mem->size, url, add_link, &p);
     }
+}
 
-    for (int i = 0; i < nodeset->nodeNr; i++) {
-        const xmlNode *node = nodeset->nodeTab[i]->xmlChildrenNode;
-        xmlChar *href = xmlNodeListGetString(doc, node, 1);
-        xmlChar *orig = href;
-        href = xmlBuildURI(href, (xmlChar *) url);
-        xmlFree(orig);
-        char *link = (char *) href;
-        if (!link) continue;
-        // attempt some form on normalisation by removing any queries or fragments
-        if (strchr(link, '?')) *strchr(link, '?') = '\0';
-        if (strchr(link, '#')) *strchr(link, '#') = '\0';
-        // we only want a map of hyperlinks, so restrict the scheme to http[s]
-        if (!strncmp(link, "http://", 7) || !strncmp(link, "https://", 8)) {
+// record a single href found on a page, queueing it if it hasn't been seen before
+void add_link(string href, void *ctx)
+{
+    page *p = ctx;
+    char *link = (char *) xmlBuildURI((xmlChar *) href, (xmlChar *) p->url);
+    if (!link) return;
+    // attempt some form on normalisation by removing any queries or fragments
+    if (strchr(link, '?')) *strchr(link, '?') = '\0';
+    if (strchr(link, '#')) *strchr(link, '#') = '\0';
+    // we only want a map of hyperlinks, so restrict the scheme to http[s]
+    if (!strncmp(link, "http://", 7) || !strncmp(link, "https://", 8)) {
+        size_t id = intern_add(p->urls, link, strlen(link));
+        if (id != INTERN_NONE) {
             // use `base_url` not url as `url` has had redirects dereferenced
-            add_or_increment_edge(network, base_url, link);
+            add_or_increment_edge(p->network, p->base_url, id);
             // have some manners and restrict hyperlinks to domains inside UNSW CSE, and that we haven't already visited.
-            if ((strstr(link, "cse.unsw.edu.au") || strstr(link, "localhost")) && !list_contains(visited, link)) {
-                list_add(visited, link);
-                list_enqueue(queue, link);
+            if ((strstr(link, "cse.unsw.edu.au") || strstr(link, "localhost")) && intern_mark(p->urls, id)
+                && !scheduler_enqueue(p->queue, id)) {
+                fprintf(stderr, "Out of memory, skipping: %s\n", link);
             }
         }
-        xmlFree(link);
     }
-    xmlXPathFreeObject(result);
-    xmlFreeDoc(doc);
+    xmlFree(link);
 }
 
-size_t grow_buffer(void *contents, size_t sz, size_t nmemb, void *ctx)
+// make room for at least needed bytes, doubling the capacity so a body costs O(log n) reallocations
+int reserve_buffer(memory *mem, size_t needed)
 {
-    size_t realsize = sz * nmemb;
-    memory *mem = (memory*) ctx;
-    char *ptr = realloc(mem->buf, mem->size + realsize);
+    if (needed <= mem->capacity) return 1;
+    size_t capacity = mem->capacity ? mem->capacity : BUFFER_INITIAL_CAPACITY;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    char *ptr = realloc(mem->buf, capacity);
     if(!ptr) {
         fprintf(stderr, "OOM\n");
         return 0;
     }
     mem->buf = ptr;
+    mem->capacity = capacity;
+    return 1;
+}
+
+size_t grow_buffer(void *contents, size_t sz, size_t nmemb, void *ctx)
+{
+    size_t realsize = sz * nmemb;
+    memory *mem = (memory*) ctx;
+    if (!reserve_buffer(mem, mem->size + realsize)) return 0;
     memcpy(&(mem->buf[mem->size]), contents, realsize);
     mem->size += realsize;
     return realsize;
 }
 
-CURL *make_handle(char *url)
+// curl write callback, which either buffers the body or, when parsing incrementally,
+// feeds it straight to a link parser so new urls reach the frontier before the transfer finishes
+size_t receive_body(void *contents, size_t sz, size_t nmemb, void *ctx)
 {
-    CURL *handle = curl_easy_init();
+    transfer *t = (transfer*) ctx;
+    // the headers have all arrived by the first body chunk, so the buffer can be sized from Content-Length,
+    // or, when parsing incrementally, the page can be vetted now
+    if (!t->body_checked) {
+        t->body_checked = 1;
+        if (!incremental) {
+            curl_off_t length = -1;
+            curl_easy_getinfo(t->handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+            if (length > 0 && length <= BUFFER_MAX_POOLED) reserve_buffer(&t->mem, (size_t) length);
+        } else {
+            long res_status = 0;
+            char *ctype = NULL, *url = NULL;
+            curl_easy_getinfo(t->handle, CURLINFO_RESPONSE_CODE, &res_status);
+            curl_easy_getinfo(t->handle, CURLINFO_CONTENT_TYPE, &ctype);
+            curl_easy_getinfo(t->handle, CURLINFO_EFFECTIVE_URL, &url);
+            if (res_status == 200 && is_html(ctype)) {
+                t->p.url = strdup(url);
+                t->parser = link_parser_create(t->p.url, add_link, &t->p);
+            }
+        }
+    }
+    if (!incremental) return grow_buffer(contents, sz, nmemb, &t->mem);
+    if (t->parser) link_parser_feed(t->parser, contents, sz * nmemb);
+    return sz * nmemb;
+}
+
+// id is the url's id in the intern pool, whose copy of it outlives every transfer
+// reuses an idle transfer, with its handle and buffer, from the pool when there is one
+CURL *make_handle(handle_pool *pool, size_t id, page *crawl)
+{
+    string url = intern_string(crawl->urls, id);
+    transfer *t = NULL;
+    if (pool->n_idle) {
+        t = pool->idle[--pool->n_idle];
+        curl_easy_reset(t->handle);
+    } else {
+        t = malloc(sizeof(transfer));
+        t->handle = curl_easy_init();
+        t->mem.buf = NULL;
+        t->mem.capacity = 0;
+    }
+    CURL *handle = t->handle;
     curl_easy_setopt(handle, CURLOPT_URL, url);
+    curl_easy_setopt(handle, CURLOPT_SHARE, pool->share);
 
     /* buffer body */
-    memory *mem = malloc(sizeof(memory));
-    mem->size = 0;
-    mem->buf = malloc(1);
-    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, grow_buffer);
-    curl_easy_setopt(handle, CURLOPT_WRITEDATA, mem);
-    curl_easy_setopt(handle, CURLOPT_PRIVATE, mem);
+    t->url = url;
+    t->mem.size = 0;
+    t->p = *crawl;
+    t->p.url = NULL;
+    t->p.base_url = id;
+    t->parser = NULL;
+    t->body_checked = 0;
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, receive_body);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, t);
+    curl_easy_setopt(handle, CURLOPT_PRIVATE, t);
 
     /* For completeness */
     curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
@@ -211,16 +455,50 @@ CURL *make_handle(char *url)
     return handle;
 }
 
+// return a finished transfer to the pool, keeping its buffer unless it grew unusually large
+void release_handle(handle_pool *pool, transfer *t)
+{
+    if (t->mem.capacity > BUFFER_MAX_POOLED) {
+        free(t->mem.buf);
+        t->mem.buf = NULL;
+        t->mem.capacity = 0;
+    }
+    if (pool->n_idle < pool->capacity) {
+        pool->idle[pool->n_idle++] = t;
+    } else {
+        curl_easy_cleanup(t->handle);
+        free(t->mem.buf);
+        free(t);
+    }
+}
+
 int is_html(char *ctype)
 {
     return ctype != NULL && strstr(ctype, "text/html");
 }
 
-void add_or_increment_edge(graph g, string vertex1, string vertex2)
+// prints the path from the seed to each destination in file, one url per line, through a single buffered writer
+void view_paths(graph network, FILE *file)
 {
-    if (!graph_has_vertex(g, vertex1)) graph_add_vertex(g, vertex1);
-    if (!graph_has_vertex(g, vertex2)) graph_add_vertex(g, vertex2);
+    writer w = writer_create(stdout);
+    if (!w) {
+        fprintf(stderr, "out of memory for the path writer\n");
+        return;
+    }
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t len;
+    while ((len = getline(&line, &size, file)) != -1) {
+        while (len > 0 && (line[len-1] == '\n' || line[len-1] == '\r')) line[--len] = '\0';
+        if (len) graph_write_path(network, line, w);
+    }
+    free(line);
+    if (!writer_destroy(w)) perror("stdout");
+}
 
-    if (!graph_has_edge(g, vertex1, vertex2)) graph_add_edge(g, vertex1, vertex2,   1);
-    else graph_set_edge(g, vertex1, vertex2,  graph_get_edge(g, vertex1, vertex2) + 1);
+void add_or_increment_edge(graph g, size_t vertex1, size_t vertex2)
+{
+    // one lookup of each vertex and of the edge, instead of a separate one for every check and update,
+    // and the vertices are found by the hashes the pool computed when the urls were interned
+    graph_increment_edge_ids(g, vertex1, vertex2);
 }
@@ -0,0 +1,82 @@
+#ifndef CSR_H
+#define CSR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "graph.h"
+
+/**
+ * An immutable, contiguous snapshot of a graph in compressed sparse row form.
+ * Vertices are numbered 0 .. nV-1 in the graph's iteration order.
+ * The outbound edges of v are out_targets[out_offsets[v] .. out_offsets[v+1]), with weights in out_weights,
+ * and the inbound edges of v are in_sources[in_offsets[v] .. in_offsets[v+1]), with weights in in_weights.
+ * The vertex names are borrowed from the graph, so the snapshot must not outlive it.
+ */
+typedef struct CSR_Repr {
+    size_t nV;
+    size_t nE;
+    string *names;
+    size_t *out_offsets;
+    size_t *out_targets;
+    size_t *out_weights;
+    size_t *in_offsets;
+    size_t *in_sources;
+    size_t *in_weights;
+    size_t *index; // open addressing table of vertex id + 1 by name hash, 0 for an empty slot
+    size_t n_slots;
+} CSR_Repr;
+
+typedef struct CSR_Repr *csr;
+
+/**
+ * graph_freeze
+ * build a snapshot of the graph's current vertices and edges
+ * return NULL on error
+ */
+csr graph_freeze (graph G);
+/**
+ * csr_destroy
+ * free all memory associated with a snapshot
+ */
+void csr_destroy (csr C);
+/**
+ * csr_find
+ * return the id of the vertex with a particular name
+ * return C->nV if there is no such vertex
+ */
+size_t csr_find (csr C, string vertex);
+/**
+ * csr_pagerank
+ * compute the PageRank of every vertex into ranks, which must hold nV values
+ * uses the same iteration and convergence test as graph_pagerank, so the ranks agree within delta
+ * each iteration is a single pass that also sums the sink rank and the contributions for the next one
+ */
+void csr_pagerank (csr C, double damping, double delta, double *ranks);
+/**
+ * csr_pagerank_parallel
+ * compute the same ranks as csr_pagerank with n_threads threads, each updating its own range of vertices
+ * the threads pull from the inbound edges, so they only write their own ranks and meet once per iteration
+ */
+void csr_pagerank_parallel (csr C, double damping, double delta, double *ranks, size_t n_threads);
+/**
+ * csr_shortest_path
+ * compute the fewest hops from source to every vertex, into dist and pred which must hold nV values each
+ * a breadth first search whose frontier is one preallocated array, and which marks a vertex visited by stamping it
+ * with the search's epoch, the search state a path_query keeps, whose next search forgets every mark in constant time
+ * by moving on to a new epoch instead of clearing them
+ * unreachable vertices get dist SIZE_MAX, and vertices without a predecessor get pred nV
+ * return false on error
+ */
+bool csr_shortest_path (csr C, size_t source, size_t *dist, size_t *pred);
+/**
+ * csr_dijkstra
+ * compute the least total edge weight from source to every vertex, into dist and pred which must hold nV values each
+ * the weights are small integers, so the frontier is a bucket queue with one bucket per distance in reach of the nearest vertex
+ * weights too large for that fall back to a binary heap
+ * unreachable vertices get dist SIZE_MAX, and vertices without a predecessor get pred nV
+ * return false on error
+ */
+bool csr_dijkstra (csr C, size_t source, size_t *dist, size_t *pred);
+
+#endif // CSR_H
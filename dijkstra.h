@@ -2,8 +2,105 @@
 #define DIJKSTRA_H
 
 #include "graph.h"
+#include "writer.h"
 
+typedef struct Path_Query_Repr *path_query;
+
+/**
+ * path_query_create
+ * allocate a query for paths in G, with arrays for every vertex so its searches allocate nothing
+ * the queries on a graph share one snapshot of it, built by the first, and each keeps its own search state,
+ * so a query per thread can search the same graph at the same time
+ * the graph must not change while the query exists
+ * return NULL on error
+ */
+path_query path_query_create (graph G);
+/**
+ * path_query_destroy
+ * free all memory associated with a query
+ */
+void path_query_destroy (path_query Q);
+/**
+ * path_query_shortest
+ * find the paths of least total edge weight from source to every vertex, forgetting the previous search in constant time
+ * return False if source is not in the graph
+ */
+bool path_query_shortest (path_query Q, string source);
+/**
+ * path_query_hops
+ * find the paths with the fewest edges from source to every vertex, ignoring the weights
+ * return False if source is not in the graph
+ */
+bool path_query_hops (path_query Q, string source);
+/**
+ * path_query_shortest_to
+ * find a path of least total edge weight from source to destination alone, searching forwards from source over the outbound
+ * edges and backwards from destination over the inbound edges until the two searches meet, which usually reaches a small
+ * part of the graph, and afterwards only destination can be viewed
+ * the backward search's arrays are allocated by the first point to point query
+ * return False if either vertex is not in the graph, or there is no path
+ */
+bool path_query_shortest_to (path_query Q, string source, string destination);
+/**
+ * path_query_hops_to
+ * find a path with the fewest edges from source to destination alone, meeting in the middle like path_query_shortest_to
+ * return False if either vertex is not in the graph, or there is no path
+ */
+bool path_query_hops_to (path_query Q, string source, string destination);
+/**
+ * path_query_distance
+ * return the total edge weight, or the number of edges for a search by hops, of the path found by the last search
+ * of the query from its source to destination
+ * return SIZE_MAX if destination is not in the graph or cannot be reached
+ */
+size_t path_query_distance (path_query Q, string destination);
+/**
+ * path_query_view
+ * print the path found by the last search of the query from its source to destination
+ * print nothing if destination is not in the graph or cannot be reached
+ */
+void path_query_view (path_query Q, string destination);
+/**
+ * path_query_write
+ * append the same line as path_query_view to a writer, so the paths to many destinations share one buffer
+ * append nothing if destination is not in the graph or cannot be reached
+ */
+void path_query_write (path_query Q, string destination, writer W);
+
+/**
+ * graph_shortest_path
+ * find the paths of least total edge weight from source to every vertex, for graph_view_path to print
+ * the search runs on a snapshot of the graph with a bucket queue, see csr_dijkstra
+ * this is a single query kept by the graph, so it is not for use from several threads at once
+ */
 void graph_shortest_path(graph, string source);
+/**
+ * graph_shortest_hops
+ * find the paths with the fewest edges from source to every vertex, ignoring the weights, for graph_view_path to print
+ * the search is a breadth first search on a snapshot of the graph, see csr_shortest_path
+ */
+void graph_shortest_hops(graph, string source);
+/**
+ * graph_shortest_path_to
+ * find a path of least total edge weight from source to destination alone for graph_view_path to print,
+ * searching from both ends at once, see path_query_shortest_to
+ */
+void graph_shortest_path_to(graph, string source, string destination);
+/**
+ * graph_shortest_hops_to
+ * find a path with the fewest edges from source to destination alone for graph_view_path to print, see path_query_hops_to
+ */
+void graph_shortest_hops_to(graph, string source, string destination);
+/**
+ * graph_view_path
+ * print the path found by the last of the searches above from its source to destination
+ * print nothing if destination is not in the graph or cannot be reached
+ */
 void graph_view_path(graph, string destination);
+/**
+ * graph_write_path
+ * append the path graph_view_path would print to a writer, to print the paths to many destinations from one search
+ */
+void graph_write_path(graph, string destination, writer);
 
 #endif // DIJKSTRA_H
@@ -4,110 +4,245 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
 
-#include "list.h"
 #include "graph.h"
 #include "pagerank.h"
 #include "dijkstra.h"
+#include "csr.h"
+#include "hash.h"
+#include "writer.h"
+#include "intern.h"
+#include "arena.h"
 
-#define MAX_VALUE 2147483647
+#define DIAL_MAX_BUCKETS (64 * 1024)
+#define INDEX_INITIAL_BUCKETS 64
+#define EDGE_HASH_MULTIPLIER ((size_t) 0x9E3779B97F4A7C15ull)
+#define SNAPSHOT_MAGIC "PRGRAPH\1"
+#define SNAPSHOT_MAGIC_SIZE 8
+#define SNAPSHOT_HEADER_SIZE 32
+#define SNAPSHOT_VARINT_MAX 10
 
 // define the structure of adjacent node
 typedef struct Adjacent_Node {
     struct Vertex_Node *v_node; // point to a vertex node
     size_t weight; // set the weight of this node
     struct Adjacent_Node *next; // point to the next adjacent node
+    struct Vertex_Node *owner; // the vertex whose outbound list holds this node
+    struct Adjacent_Node *enext; // point to the next outbound node in the same edge index bucket
 } Adjacent_Node;
 
+// define the structure of inbound node, which only records where an edge comes from
+typedef struct Inbound_Node {
+    struct Vertex_Node *v_node; // point to the vertex the edge comes from
+    struct Inbound_Node *next; // point to the next inbound node
+} Inbound_Node;
+
 // define the structure of vertex node as a double linked list
 typedef struct Vertex_Node {
     string data; // the information that this vertex had
+    size_t len; // the length of data, so it can be written without scanning it again
     double oldrank; // old rank of the page
     double pagerank; // current rank of the page;
     size_t D; // the number of outbound edges of vertex;
     struct Vertex_Node *next; // point to the next vertex
     struct Vertex_Node *prev; // point to the previous vertex
     struct Adjacent_Node *first; // point to the first adjacent node
-    struct Adjacent_Node *inbound_first; // record the vertices which have edges point to this vertex
-    struct Vertex_Node *pred; // used for Dijkstra
-    size_t dist; // used for Dijkstra
-    bool source; // used for Dijkstra to identify the source node
-    bool visited; // used for Dijkstra
+    struct Adjacent_Node *last; // point to the last adjacent node, so an edge is appended without walking the list
+    struct Inbound_Node *inbound_first; // record the vertices which have edges point to this vertex
+    struct Inbound_Node *inbound_last; // point to the last inbound record
+    size_t hash; // cached hash of data, used by the vertex index
+    struct Vertex_Node *hnext; // point to the next vertex in the same index bucket
+    size_t id; // position of the vertex in the last snapshot taken by graph_freeze
 } Vertex_Node;
 
+// define a slab of nodes of one size, a released node is kept on free_list for the next allocation
+typedef struct Slab {
+    struct Arena arena; // where the nodes are carved from
+    void *free_list;
+    size_t item_size;
+} Slab;
+
 // define the graph structure
 typedef struct Graph_Repr {
     struct Vertex_Node *first; // point to the first vertex
     struct Vertex_Node *last; // point to the last vertex
     int nV; // record the total number of vertex
     int nE; // record the total number of edges
+    struct Vertex_Node **buckets; // hash index from vertex data to vertex node
+    size_t n_buckets; // the number of buckets in the index, always a power of two
+    struct Adjacent_Node **edge_buckets; // hash index from a pair of vertices to the outbound node of their edge
+    size_t n_edge_buckets; // the number of buckets in the edge index, always a power of two
+    struct Vertex_Node **ranked; // the vertices in rank order, built by graph_viewrank and NULL until then
+    double rank_epsilon; // the delta of the last PageRank run, ranks in the same band this wide are ordered by url
+    struct CSR_Repr *paths; // the snapshot path queries run on, NULL until one is asked for and after any change
+    pthread_mutex_t paths_lock; // held while the snapshot for path queries is built
+    struct Path_Query_Repr *query; // the query behind graph_shortest_path and graph_view_path, NULL until the first
+    intern_pool pool; // where the vertex values live when they are shared with the caller, NULL if the graph owns them
+    struct Slab vertices; // every Vertex_Node of the graph
+    struct Slab edges; // every Adjacent_Node of the graph
+    struct Slab inbound; // every Inbound_Node of the graph
+    struct Arena names; // the vertex values the graph owns, packed without alignment
 } Graph_Repr;
-// ================================Struct and utility functions for Dijkstra============================================
-typedef struct List_Repr {
-    struct Node *head;
-    size_t length;
-    struct Node *tail;
-} List_Repr;
-
-typedef struct Node {
-    struct Vertex_Node *node_vertex;
-    struct Node *next;
-    struct Node *prev;
-} Node;
-
-void graph_dijkstra_enqueue (list ddlist, Vertex_Node *value) {
-    Node *new = malloc(sizeof(*new));
-    new->next = NULL;
-    new->prev = NULL;
-    new->node_vertex = value;
-    if (!ddlist->head) {
-        ddlist->tail = ddlist->head = new;
-    } else {
-        new->next = ddlist->head;
-        ddlist->head->prev = new;
-        ddlist->head = new;
+
+// ===========================================slab allocation===========================================================
+
+// This function is to prepare an empty slab for nodes of item_size bytes.
+void slab_init (Slab *S, size_t item_size) {
+    size_t unit = sizeof(Arena_Unit);
+    arena_init(&S->arena);
+    S->free_list = NULL;
+    // every node is rounded up to the alignment of the arena's blocks, so the next one stays aligned too
+    S->item_size = (item_size + unit - 1) / unit * unit;
+}
+
+// This function is to allocate a node, reusing one that has been released when there is one.
+void *slab_alloc (Slab *S) {
+    if (S->free_list) {
+        void *item = S->free_list;
+        S->free_list = *(void **) item;
+        return item;
     }
-    ddlist->length++;
+    return arena_carve(&S->arena, S->item_size);
 }
 
-Vertex_Node* graph_dijkstra_dequeue (list ddlist) {
-    if (ddlist->tail) {
-        Vertex_Node *data = ddlist->tail->node_vertex;
-        if (ddlist->tail == ddlist->head) {
-            free(ddlist->tail);
-            ddlist->tail = ddlist->head = NULL;
-            ddlist->length--;
-            return data;
-        } else {
-            ddlist->tail = ddlist->tail->prev;
-            free(ddlist->tail->next);
-            ddlist->tail->next = NULL;
-            ddlist->length--;
-            return data;
-        }
-    } else {
-        return NULL;
+// This function is to release a node, its memory is handed out again by the next slab_alloc.
+void slab_free (Slab *S, void *item) {
+    *(void **) item = S->free_list;
+    S->free_list = item;
+}
+
+// This function is to free every block of the slab at once, along with all the nodes in it.
+void slab_destroy (Slab *S) {
+    arena_destroy(&S->arena);
+    S->free_list = NULL;
+}
+
+// ===========================================utility functions=========================================================
+
+// This function is to find the vertex node whose value is the len bytes at vertex, by the hash index, NULL if it does not exist.
+Vertex_Node *graph_find_vertex_bytes (graph G, const char *vertex, size_t len, size_t h) {
+    if (!G->n_buckets) return NULL;
+    Vertex_Node *p = G->buckets[h & (G->n_buckets - 1)];
+    // a value from the graph's pool is found by its address, without comparing the characters
+    while (p && p->data != vertex && (p->hash != h || strncmp(p->data, vertex, len) != 0 || p->data[len] != '\0')) {
+        p = p->hnext;
+    }
+    return p;
+}
+
+// This function is to find the vertex node with a particular value by the hash index, NULL if it does not exist.
+Vertex_Node *graph_find_vertex (graph G, string vertex) {
+    return graph_find_vertex_bytes(G, vertex, strlen(vertex), hash_string(vertex));
+}
+
+// This function is to double the number of buckets once the index is fully loaded.
+void graph_index_grow (graph G) {
+    size_t n_buckets = G->n_buckets ? G->n_buckets * 2 : INDEX_INITIAL_BUCKETS;
+    Vertex_Node **buckets = calloc(n_buckets, sizeof(*buckets));
+    if (!buckets) return;
+    Vertex_Node *p = G->first;
+    while (p) {
+        size_t b = p->hash & (n_buckets - 1);
+        p->hnext = buckets[b];
+        buckets[b] = p;
+        p = p->next;
+    }
+    free(G->buckets);
+    G->buckets = buckets;
+    G->n_buckets = n_buckets;
+}
+
+// This function is to record a new vertex in the hash index.
+void graph_index_insert (graph G, Vertex_Node *vertex) {
+    if ((size_t) G->nV >= G->n_buckets) graph_index_grow(G);
+    size_t b = vertex->hash & (G->n_buckets - 1);
+    vertex->hnext = G->buckets[b];
+    G->buckets[b] = vertex;
+}
+
+// This function is to forget a vertex from the hash index before it is freed.
+void graph_index_remove (graph G, Vertex_Node *vertex) {
+    Vertex_Node **pp = &G->buckets[vertex->hash & (G->n_buckets - 1)];
+    while (*pp && *pp != vertex) {
+        pp = &(*pp)->hnext;
+    }
+    if (*pp) *pp = vertex->hnext;
+}
+
+// This function is to combine the cached hashes of the two ends of an edge into the hash of the edge.
+size_t edge_hash (Vertex_Node *vertex1, Vertex_Node *vertex2) {
+    return (vertex1->hash * EDGE_HASH_MULTIPLIER) ^ vertex2->hash;
+}
+
+// This function is to find the outbound node of the edge from vertex1 to vertex2 by the edge index, NULL if it does not exist.
+Adjacent_Node *graph_find_adjacent (graph G, Vertex_Node *vertex1, Vertex_Node *vertex2) {
+    if (!G->n_edge_buckets) return NULL;
+    Adjacent_Node *e = G->edge_buckets[edge_hash(vertex1, vertex2) & (G->n_edge_buckets - 1)];
+    while (e && (e->owner != vertex1 || e->v_node != vertex2)) {
+        e = e->enext;
     }
+    return e;
 }
 
-void graph_dijkstra_destroy (list ddlist) {
-    if (ddlist->head) {
-        Node *no_cur = ddlist->head;
-        while (no_cur) {
-            Node *temp = no_cur;
-            no_cur = no_cur->next;
-            free(temp);
+// This function is to double the number of edge buckets once the edge index is fully loaded.
+void graph_edge_index_grow (graph G) {
+    size_t n_buckets = G->n_edge_buckets ? G->n_edge_buckets * 2 : INDEX_INITIAL_BUCKETS;
+    Adjacent_Node **buckets = calloc(n_buckets, sizeof(*buckets));
+    if (!buckets) return;
+    for (Vertex_Node *p = G->first; p; p = p->next) {
+        for (Adjacent_Node *e = p->first; e; e = e->next) {
+            size_t b = edge_hash(p, e->v_node) & (n_buckets - 1);
+            e->enext = buckets[b];
+            buckets[b] = e;
         }
-        ddlist->length = 0;
     }
-    free(ddlist);
+    free(G->edge_buckets);
+    G->edge_buckets = buckets;
+    G->n_edge_buckets = n_buckets;
 }
 
-// ===========================================utility functions=========================================================
+// This function is to record a new outbound node in the edge index, it must already be counted in nE.
+void graph_edge_index_insert (graph G, Adjacent_Node *edge) {
+    if ((size_t) G->nE > G->n_edge_buckets) graph_edge_index_grow(G);
+    // a failed grow leaves no buckets at all the first time round
+    if (!G->n_edge_buckets) return;
+    size_t b = edge_hash(edge->owner, edge->v_node) & (G->n_edge_buckets - 1);
+    edge->enext = G->edge_buckets[b];
+    G->edge_buckets[b] = edge;
+}
+
+// This function is to forget an outbound node from the edge index before it is freed.
+void graph_edge_index_remove (graph G, Adjacent_Node *edge) {
+    if (!G->n_edge_buckets) return;
+    Adjacent_Node **pp = &G->edge_buckets[edge_hash(edge->owner, edge->v_node) & (G->n_edge_buckets - 1)];
+    while (*pp && *pp != edge) {
+        pp = &(*pp)->enext;
+    }
+    if (*pp) *pp = edge->enext;
+}
+
+// This function is to take the node pointing at vertex out of the list from *first to *last, NULL if there is none.
+Adjacent_Node *adjacent_unlink (Adjacent_Node **first, Adjacent_Node **last, Vertex_Node *vertex) {
+    Adjacent_Node *prev = NULL, *temp = *first;
+    while (temp && temp->v_node != vertex) {
+        prev = temp;
+        temp = temp->next;
+    }
+    if (!temp) return NULL;
+    if (prev) {
+        prev->next = temp->next;
+    } else {
+        *first = temp->next;
+    }
+    if (*last == temp) *last = prev;
+    return temp;
+}
 
 // This function is used in page_rank calculation, which is to calculate if all the pagerank is accurately enough.
 bool is_differ_accepted (graph G, double delta) {
@@ -122,132 +257,231 @@ bool is_differ_accepted (graph G, double delta) {
     return true;
 }
 
+// This function is to drop the snapshot kept for path queries once a vertex, an edge or a weight changes
+void graph_clear_paths (graph G) {
+    if (!G->paths) return;
+    path_query_destroy(G->query);
+    csr_destroy(G->paths);
+    G->query = NULL;
+    G->paths = NULL;
+}
+
 // this function is to record the inbound node for the vertex.
 void vertex_add_inbound_node (graph G, Vertex_Node *vertex1, Vertex_Node *vertex2) {
-    Adjacent_Node *new = malloc(sizeof(*new));
+    Inbound_Node *new = slab_alloc(&G->inbound);
+    if (!new) return;
     new->next = NULL;
-    new->weight = 0;
     new->v_node = vertex1;
-    if (vertex2->inbound_first) {
-        Adjacent_Node *p = vertex2->inbound_first;
-        while (p->next) {
-            p = p->next;
-        }
-        p->next = new;
+    if (vertex2->inbound_last) {
+        vertex2->inbound_last->next = new;
     } else {
         vertex2->inbound_first = new;
     }
-}
-
-void adjacent_remove_inbound_node (graph G, Adjacent_Node *adj, Vertex_Node *vertex1, Vertex_Node *vertex2) {
-    if (adj->next) {
-        while (adj->next) {
-            if (strcmp(adj->next->v_node->data, vertex1->data) == 0) {
-                Adjacent_Node *temp = adj->next;
-                adj->next = adj->next->next;
-                free(temp);
-                return;
-            } else {
-                adj = adj->next;
-            }
-        }
-    } else {
-        adj = NULL;
-        vertex2->inbound_first = NULL;
-        free(adj);
-    }
+    vertex2->inbound_last = new;
 }
 
 // This function is to remove inbound node when its relevant edge has been removed.
-void vertex_remove_inbound_node (graph G, Vertex_Node *vertex1, string v2_data) {
-    if (!vertex1->first->next && strcmp(vertex1->first->v_node->data, v2_data) == 0) {
-        Adjacent_Node *p = vertex1->first->v_node->inbound_first;
-        Vertex_Node *vertex2 = vertex1->first->v_node;
-        adjacent_remove_inbound_node(G, p, vertex1, vertex2);
+void vertex_remove_inbound_node (graph G, Vertex_Node *vertex1, Vertex_Node *vertex2) {
+    Inbound_Node *prev = NULL, *temp = vertex2->inbound_first;
+    while (temp && temp->v_node != vertex1) {
+        prev = temp;
+        temp = temp->next;
+    }
+    if (!temp) return;
+    if (prev) {
+        prev->next = temp->next;
     } else {
-        Adjacent_Node *p = vertex1->first;
-        while(p) {
-            if (strcmp(p->v_node->data, v2_data) == 0) {
-                Adjacent_Node *p2 = p->v_node->inbound_first;
-                Vertex_Node *vertex2 = p->v_node;
-                adjacent_remove_inbound_node(G, p2, vertex1, vertex2);
-            } else {
-                p = p->next;
-            }
-        }
+        vertex2->inbound_first = temp->next;
     }
+    if (vertex2->inbound_last == temp) vertex2->inbound_last = prev;
+    slab_free(&G->inbound, temp);
 }
 
-// This function is to add adjacent node to the vertex.
-void vertex_add_Adjacent_Node (graph G, Vertex_Node *vertex1, string v2_data, Adjacent_Node *temp, size_t weight) {
-    Adjacent_Node *new = malloc(sizeof(*new));
+// This function is to append an adjacent node to the vertex, without looking for an existing edge.
+Adjacent_Node *vertex_add_Adjacent_Node (graph G, Vertex_Node *vertex1, Vertex_Node *vertex2, size_t weight) {
+    Adjacent_Node *new = slab_alloc(&G->edges);
+    if (!new) return NULL;
     new->next = NULL;
     new->weight = weight;
+    new->v_node = vertex2;
+    new->owner = vertex1;
     G->nE++;
     vertex1->D++;
-    if (!temp) {
-        vertex1->first = new;
+    graph_clear_paths(G);
+    // indexed before it is linked, so a grow of the index does not meet it twice
+    graph_edge_index_insert(G, new);
+    if (vertex1->last) {
+        vertex1->last->next = new;
     } else {
-        temp->next = new;
-    }
-    Vertex_Node *p2 = G->first;
-    while(p2 && strcmp(p2->data, v2_data) != 0) {
-        p2 = p2->next;
+        vertex1->first = new;
     }
-    new->v_node = p2;
-    vertex_add_inbound_node(G, vertex1, p2);
+    vertex1->last = new;
+    vertex_add_inbound_node(G, vertex1, vertex2);
+    return new;
 }
 
-// This function is to help sort function to swap two vertices
-void vertex_swap (graph G, Vertex_Node *vertex1, Vertex_Node *vertex2) {
-    if (vertex1->next) {
-        vertex1->next->prev = vertex2;
-        vertex2->next = vertex1->next;
-        vertex2->prev->next = vertex1;
-        vertex1->next = vertex2;
-        vertex1->prev = vertex2->prev;
-        vertex2->prev = vertex1;
-    } else {
-        vertex2->next = NULL;
-        vertex2->prev->next = vertex1;
-        vertex1->next = vertex2;
-        vertex1->prev = vertex2->prev;
-        vertex2->prev = vertex1;
-        G->last = vertex2;
-    }
+// This function is to put a rank in its band, the ranks are cut into bands epsilon wide and compared band by band.
+// Asking whether two ranks are closer than epsilon would not be transitive, and the full sort and the top-k heap
+// could then order the same vertices differently.
+double rank_band (double rank, double epsilon) {
+    return epsilon > 0 ? floor(rank / epsilon) : rank;
+}
 
+// This function decides whether vertex1 comes before vertex2 in the ranked view:
+// higher rank band first, and ranks in the same band by their url
+bool vertex_ranks_before (Vertex_Node *vertex1, Vertex_Node *vertex2, double epsilon) {
+    double band1 = rank_band(vertex1->pagerank, epsilon);
+    double band2 = rank_band(vertex2->pagerank, epsilon);
+    if (band1 != band2) return band1 > band2;
+    return epsilon > 0 && strcmp(vertex1->data, vertex2->data) < 0;
 }
 
-// This function is to sort the vertex list by insertion sort method
-void graph_sorted(graph G, double epsilon) {
-    if (!G) return;
-    if (!G->first) return;
-
-    Vertex_Node *p1 = G->first;
-    while (p1) {
-        Vertex_Node *p2 = p1->next;
-        while(p2 && p2->prev) {
-            if ((p2->pagerank - p2->prev->pagerank) > epsilon) {
-                vertex_swap(G, p2, p2->prev);
-                p2 = p2->prev;
-            } else if (fabs(p2->pagerank - p2->prev->pagerank) < epsilon) {
-                if (strcmp(p2->data, p2->prev->data) < 0) {
-                    vertex_swap(G, p2, p2->prev);
-                    p2 = p2->prev;
-                } else {
-                    p2 = p2->prev;
-                }
-            } else {
-                p2 = p2->prev;
+// This function is to sort the vertices by rank with a bottom-up merge sort,
+// which is stable, so vertices neither before the other keep their list order
+void vertex_rank_sort (Vertex_Node **vertices, size_t n, double epsilon) {
+    Vertex_Node **buffer = malloc(n * sizeof(*buffer));
+    if (!buffer) return;
+    Vertex_Node **from = vertices, **to = buffer;
+    for (size_t width = 1; width < n; width *= 2) {
+        for (size_t lo = 0; lo < n; lo += 2 * width) {
+            size_t mid = lo + width < n ? lo + width : n;
+            size_t hi = lo + 2 * width < n ? lo + 2 * width : n;
+            size_t i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) {
+                // take from the right run only when it strictly comes first
+                to[k++] = vertex_ranks_before(from[j], from[i], epsilon) ? from[j++] : from[i++];
             }
+            while (i < mid) to[k++] = from[i++];
+            while (j < hi) to[k++] = from[j++];
         }
-        p1 = p1->next;
+        Vertex_Node **temp = from;
+        from = to;
+        to = temp;
+    }
+    if (from != vertices) {
+        memcpy(vertices, from, n * sizeof(*vertices));
     }
-    if (G->first->prev) {
-        while (G->first->prev) {
-            G->first = G->first->prev;
+    free(buffer);
+}
+
+// This function is to build the ranked view of the graph from the ranks of the last PageRank run
+void graph_build_ranked (graph G) {
+    free(G->ranked);
+    G->ranked = malloc(G->nV * sizeof(*G->ranked));
+    if (!G->ranked) return;
+    size_t n = 0;
+    for (Vertex_Node *p = G->first; p; p = p->next) {
+        G->ranked[n++] = p;
+    }
+    vertex_rank_sort(G->ranked, n, G->rank_epsilon);
+}
+
+// an entry of the top-k heap, order is the position in the vertex list so ties keep the full sort's order
+typedef struct Ranked_Entry {
+    Vertex_Node *vertex;
+    size_t order;
+} Ranked_Entry;
+
+// This function decides whether entry1 comes after entry2, the heap keeps the entry that comes last at its root
+bool ranked_entry_after (Ranked_Entry *entry1, Ranked_Entry *entry2, double epsilon) {
+    if (vertex_ranks_before(entry2->vertex, entry1->vertex, epsilon)) return true;
+    if (vertex_ranks_before(entry1->vertex, entry2->vertex, epsilon)) return false;
+    return entry1->order > entry2->order;
+}
+
+void ranked_heap_sift_down (Ranked_Entry *heap, size_t n, size_t i, double epsilon) {
+    for (;;) {
+        size_t last = i, left = 2 * i + 1, right = 2 * i + 2;
+        if (left < n && ranked_entry_after(&heap[left], &heap[last], epsilon)) last = left;
+        if (right < n && ranked_entry_after(&heap[right], &heap[last], epsilon)) last = right;
+        if (last == i) return;
+        Ranked_Entry temp = heap[i];
+        heap[i] = heap[last];
+        heap[last] = temp;
+        i = last;
+    }
+}
+
+void ranked_heap_sift_up (Ranked_Entry *heap, size_t i, double epsilon) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!ranked_entry_after(&heap[i], &heap[parent], epsilon)) return;
+        Ranked_Entry temp = heap[i];
+        heap[i] = heap[parent];
+        heap[parent] = temp;
+        i = parent;
+    }
+}
+
+// This function is to drop the ranked view once the ranks or the vertices change
+void graph_clear_ranked (graph G) {
+    free(G->ranked);
+    G->ranked = NULL;
+}
+
+// This function is to append a new vertex, whose value is the len bytes at vertex, to the list and the index.
+// id is the value's id in the graph's pool when the caller already has it, INTERN_NONE otherwise.
+Vertex_Node *graph_insert_vertex (graph G, const char *vertex, size_t len, size_t h, size_t id) {
+    Vertex_Node *new = slab_alloc(&G->vertices);
+    if (!new) return NULL;
+    new->D = 0;
+    new->oldrank = 0;
+    new->pagerank = 0;
+    new->inbound_first = new->inbound_last = NULL;
+    new->first = new->last = NULL;
+    new->next = new->prev = NULL;
+    if (G->pool) {
+        // the pool keeps the only copy
+        if (id == INTERN_NONE) id = intern_add(G->pool, vertex, len);
+        if (id == INTERN_NONE) {
+            slab_free(&G->vertices, new);
+            return NULL;
         }
+        new->data = intern_string(G->pool, id);
+    } else {
+        new->data = arena_copy(&G->names, vertex, len);
+        if (!new->data) {
+            slab_free(&G->vertices, new);
+            return NULL;
+        }
+    }
+    new->len = len;
+    new->hash = h;
+    graph_index_insert(G, new);
+    graph_clear_ranked(G);
+    graph_clear_paths(G);
+    if (!G->first) {
+        G->first = new;
+    } else {
+        G->last->next = new;
+        new->prev = G->last;
     }
+    G->last = new;
+    G->nV++;
+    return new;
+}
+
+// This function is to find the vertex whose value is the len bytes at vertex, adding it if it does not exist.
+Vertex_Node *graph_intern_vertex (graph G, const char *vertex, size_t len) {
+    size_t h = hash_bytes(vertex, len);
+    Vertex_Node *p = graph_find_vertex_bytes(G, vertex, len, h);
+    if (!p) {
+        p = graph_insert_vertex(G, vertex, len, h, INTERN_NONE);
+    }
+    return p;
+}
+
+// This function is to find the vertex whose value has a particular id in the graph's pool, adding it if it does not exist.
+// The pool already holds the value's length and hash, so nothing is measured, hashed or copied again.
+Vertex_Node *graph_intern_id (graph G, size_t id) {
+    string vertex = intern_string(G->pool, id);
+    size_t len = intern_length(G->pool, id);
+    size_t h = intern_hash(G->pool, id);
+    Vertex_Node *p = graph_find_vertex_bytes(G, vertex, len, h);
+    if (!p) {
+        p = graph_insert_vertex(G, vertex, len, h, id);
+    }
+    return p;
 }
 //======================================================================================================================
 
@@ -258,23 +492,42 @@ graph graph_create (void) {
     graph g = malloc(sizeof(*g));
     g->first = g->last = NULL;
     g->nE = g->nV = 0;
+    g->buckets = NULL;
+    g->n_buckets = 0;
+    g->edge_buckets = NULL;
+    g->n_edge_buckets = 0;
+    g->ranked = NULL;
+    g->paths = NULL;
+    g->query = NULL;
+    pthread_mutex_init(&g->paths_lock, NULL);
+    g->rank_epsilon = 0;
+    g->pool = NULL;
+    slab_init(&g->vertices, sizeof(Vertex_Node));
+    slab_init(&g->edges, sizeof(Adjacent_Node));
+    slab_init(&g->inbound, sizeof(Inbound_Node));
+    arena_init(&g->names);
+    return g;
+}
+
+graph graph_create_interned (intern_pool pool) {
+    graph g = graph_create();
+    if (!g) return NULL;
+    g->pool = pool;
     return g;
 }
 
 void graph_destroy (graph G) {
-    if (G->first == NULL) {
-        free(G);
-        return;
-    } else {
-        Vertex_Node *curr = G->first;
-        while (curr) {
-            Vertex_Node *temp = curr;
-            curr = curr->next;
-            free(temp->data);
-            free(temp);
-        }
-        free(G);
-    }
+    // the nodes and the values are never freed one by one, their slabs go in a single pass over the blocks
+    slab_destroy(&G->vertices);
+    slab_destroy(&G->edges);
+    slab_destroy(&G->inbound);
+    arena_destroy(&G->names);
+    graph_clear_paths(G);
+    pthread_mutex_destroy(&G->paths_lock);
+    free(G->buckets);
+    free(G->edge_buckets);
+    free(G->ranked);
+    free(G);
 }
 
 void graph_show (graph G, FILE *file) {
@@ -283,146 +536,223 @@ void graph_show (graph G, FILE *file) {
     if (!file) {
         file = stdout;
     }
+    // the lines are assembled in a large buffer with the url lengths already known, instead of a fprintf per line
+    writer w = writer_create(file);
+    if (!w) return;
     Vertex_Node *p = G->first;
     while (p) {
-        fprintf(file, "%s\n", p->data);
+        writer_bytes(w, p->data, p->len);
+        writer_char(w, '\n');
         p = p->next;
     }
     p = G->first;
     while (p) {
         Adjacent_Node *temp = p->first;
         while(temp) {
-            fprintf(file, "%s %s %lu\n", p->data, temp->v_node->data, temp->weight);
+            writer_bytes(w, p->data, p->len);
+            writer_char(w, ' ');
+            writer_bytes(w, temp->v_node->data, temp->v_node->len);
+            writer_char(w, ' ');
+            writer_size(w, temp->weight);
+            writer_char(w, '\n');
             temp = temp->next;
         }
         p = p->next;
     }
+    writer_destroy(w);
+}
+// This function is to write a number as a little endian 64 bit field of the snapshot header.
+void snapshot_put_u64 (unsigned char *buf, uint64_t value) {
+    for (size_t i = 0; i < 8; i++) {
+        buf[i] = value >> (8 * i);
+    }
 }
-// vertex interface
 
-void graph_add_vertex (graph G, string vertex) {
-    if (!G) return;
-    if (!G->first) {
-        Vertex_Node *new = malloc(sizeof(*new));
-        new->D = 0;
-        new->oldrank = 0;
-        new->pagerank = 0;
-        new->visited = false;
-        new->inbound_first = NULL;
-        new->first = NULL;
-        new->next =new->prev = NULL;
-        new->data = strdup(vertex);
-        new->pred = NULL;
-        new->source = false;
-        new->dist = MAX_VALUE;
-        G->first = new;
-        G->last = new;
-        G->nV++;
-    } else {
-        Vertex_Node *p = G->first;
-        while(p && strcmp(p->data, vertex) != 0) {
-            p = p->next;
+uint64_t snapshot_get_u64 (const unsigned char *buf) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; i++) {
+        value |= (uint64_t) buf[i] << (8 * i);
+    }
+    return value;
+}
+
+// This function is to append a number to buf as a varint, seven bits per byte with the high bit set on all but the last.
+size_t snapshot_put_varint (unsigned char *buf, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        buf[n++] = (value & 0x7f) | 0x80;
+        value >>= 7;
+    }
+    buf[n++] = value;
+    return n;
+}
+
+// This function is to read a varint at *pos, false if it runs past end or is longer than 64 bits.
+bool snapshot_get_varint (const unsigned char **pos, const unsigned char *end, uint64_t *value) {
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (*pos == end) return false;
+        unsigned char byte = *(*pos)++;
+        result |= (uint64_t) (byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
         }
-        if (!p) {
-            Vertex_Node *new = malloc(sizeof(*new));
-            new->D = 0;
-            new->oldrank = 0;
-            new->pagerank = 0;
-            new->pred = NULL;
-            new->dist = MAX_VALUE;
-            new->source = false;
-            new->visited = false;
-            new->inbound_first = NULL;
-            new->first = NULL;
-            new->next =new->prev = NULL;
-            new->data = strdup(vertex);
-            G->last->next = new;
-            new->prev = G->last;
-            G->last = new;
-            G->nV++;
+    }
+    return false;
+}
+
+bool graph_save (graph G, FILE *file) {
+    if (!G || !file) return false;
+    // the vertices are numbered in list order, which is also the order of the string table
+    uint64_t strings_size = 0;
+    size_t id = 0;
+    for (Vertex_Node *p = G->first; p; p = p->next) {
+        p->id = id++;
+        strings_size += strlen(p->data) + 1;
+    }
+    unsigned char header[SNAPSHOT_HEADER_SIZE];
+    memcpy(header, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+    snapshot_put_u64(header + 8, G->nV);
+    snapshot_put_u64(header + 16, G->nE);
+    snapshot_put_u64(header + 24, strings_size);
+    if (fwrite(header, 1, sizeof(header), file) != sizeof(header)) return false;
+    for (Vertex_Node *p = G->first; p; p = p->next) {
+        if (fwrite(p->data, 1, strlen(p->data) + 1, file) != strlen(p->data) + 1) return false;
+    }
+    // each vertex's edges are its out degree and then a target id and weight per edge, in list order
+    unsigned char buf[3 * SNAPSHOT_VARINT_MAX];
+    for (Vertex_Node *p = G->first; p; p = p->next) {
+        size_t n = snapshot_put_varint(buf, p->D);
+        if (fwrite(buf, 1, n, file) != n) return false;
+        for (Adjacent_Node *adj = p->first; adj; adj = adj->next) {
+            n = snapshot_put_varint(buf, adj->v_node->id);
+            n += snapshot_put_varint(buf + n, adj->weight);
+            if (fwrite(buf, 1, n, file) != n) return false;
         }
     }
+    return true;
 }
 
-bool graph_has_vertex (graph G, string vertex) {
-    if (!G) return false;
-    if (G->first) {
-        Vertex_Node *p = G->first;
-        while (p) {
-            if (strcmp(vertex, p->data) == 0) {
-                return true;
-            } else {
-                p = p->next;
-            }
+bool graph_is_snapshot (const char *buf, size_t size) {
+    return size >= SNAPSHOT_MAGIC_SIZE && memcmp(buf, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) == 0;
+}
+
+graph graph_read_snapshot (const char *buf, size_t size) {
+    if (!graph_is_snapshot(buf, size) || size < SNAPSHOT_HEADER_SIZE) return NULL;
+    const unsigned char *header = (const unsigned char *) buf;
+    uint64_t n_vertices = snapshot_get_u64(header + 8);
+    uint64_t n_edges = snapshot_get_u64(header + 16);
+    uint64_t strings_size = snapshot_get_u64(header + 24);
+    // every vertex takes at least a byte of the string table and every edge two bytes of the edge lists
+    if (strings_size > size - SNAPSHOT_HEADER_SIZE || n_vertices > strings_size) return NULL;
+    const char *strings = buf + SNAPSHOT_HEADER_SIZE;
+    const unsigned char *pos = (const unsigned char *) strings + strings_size;
+    const unsigned char *end = (const unsigned char *) buf + size;
+    if (n_edges > (size_t) (end - pos) / 2) return NULL;
+
+    graph G = graph_create();
+    Vertex_Node **vertices = malloc(n_vertices * sizeof(*vertices));
+    if (!G || (n_vertices && !vertices)) {
+        free(vertices);
+        if (G) graph_destroy(G);
+        return NULL;
+    }
+    bool ok = true;
+    const char *name = strings, *strings_end = strings + strings_size;
+    for (size_t i = 0; ok && i < n_vertices; i++) {
+        const char *nul = memchr(name, '\0', strings_end - name);
+        if (!nul) {
+            ok = false;
+            break;
         }
-    } else {
-        return false;
+        size_t before = G->nV;
+        vertices[i] = graph_intern_vertex(G, name, nul - name);
+        // a name that is already taken would leave a hole in the ids
+        ok = (size_t) G->nV > before;
+        name = nul + 1;
     }
-    return false;
+    // the edges were unique in the graph that was saved, so a repeated one means the file is not a snapshot
+    for (size_t i = 0; ok && i < n_vertices; i++) {
+        uint64_t degree;
+        ok = snapshot_get_varint(&pos, end, &degree) && degree <= n_vertices;
+        for (uint64_t e = 0; ok && e < degree; e++) {
+            uint64_t target, weight;
+            ok = snapshot_get_varint(&pos, end, &target) && snapshot_get_varint(&pos, end, &weight) && target < n_vertices
+                 && !graph_find_adjacent(G, vertices[i], vertices[target]);
+            if (!ok) break;
+            vertex_add_Adjacent_Node(G, vertices[i], vertices[target], weight);
+        }
+    }
+    free(vertices);
+    if (!ok || (uint64_t) G->nE != n_edges || pos != end) {
+        graph_destroy(G);
+        return NULL;
+    }
+    return G;
+}
+
+// vertex interface
+
+void graph_add_vertex (graph G, string vertex) {
+    if (!G) return;
+    graph_intern_vertex(G, vertex, strlen(vertex));
+}
+
+void graph_add_vertex_bytes (graph G, const char *vertex, size_t len) {
+    if (!G) return;
+    graph_intern_vertex(G, vertex, len);
+}
+
+bool graph_has_vertex (graph G, string vertex) {
+    if (!G) return false;
+    return graph_find_vertex(G, vertex) != NULL;
 }
 
 void graph_remove_vertex (graph G, string vertex) {
     if (!G) return;
-    if (G->first) {
-        Vertex_Node *p = G->first;
-        // This is to remove all the inbound nodes of which vertex have edges with.
-        while (p) {
-            Adjacent_Node *adj = p->inbound_first;
-            if (adj->next) {
-                while (adj->next) {
-                    if (strcmp(adj->next->v_node->data, vertex) == 0) {
-                        Adjacent_Node *temp = adj->next;
-                        adj->next = adj->next->next;
-                        free(temp);
-                    } else {
-                        adj = adj->next;
-                    }
-                }
-            } else {
-                if (strcmp(adj->v_node->data, vertex) == 0) {
-                    free(adj);
-                    p->inbound_first = NULL;
-                }
-            }
-            p = p->next;
-        }
-        p = G->first;
-        while (p && strcmp(vertex, p->data) != 0) {
-            p = p->next;
-        }
-        if (p && G->first != G->last) {
-            if (p->first->next) {
-                Adjacent_Node *curr = p->first;
-                Adjacent_Node *next = p->first->next;
-                while(next) {
-                    if (strcmp(next->v_node->data, vertex) == 0) {
-                        curr->next = next->next;
-                        free(next);
-                        next = curr->next;
-                        G->nE--;
-                    } else {
-                        curr = next;
-                        next = next->next;
-                    }
-                }
-            } else {
-                if (strcmp(p->first->v_node->data, vertex) == 0) {
-                    Adjacent_Node *temp = p->first;
-                    p->first = NULL;
-                    free(temp);
-                    G->nE--;
-                }
-            }
-            p->next->prev = p->prev;
-            p->prev->next = p->next;
-            free(p);
-            G->nV--;
-        } else {
-            G->first = G->last = NULL;
-            G->nV--;
-            free(p);
+    Vertex_Node *p = graph_find_vertex(G, vertex);
+    if (!p) return;
+    // This is to remove all the outbound edges of the vertex, along with their inbound records.
+    while (p->first) {
+        Adjacent_Node *temp = p->first;
+        p->first = temp->next;
+        graph_edge_index_remove(G, temp);
+        vertex_remove_inbound_node(G, p, temp->v_node);
+        slab_free(&G->edges, temp);
+        G->nE--;
+    }
+    // This is to remove all the edges which point to the vertex from the other vertices.
+    while (p->inbound_first) {
+        Vertex_Node *from = p->inbound_first->v_node;
+        Adjacent_Node *edge = graph_find_adjacent(G, from, p);
+        if (edge) {
+            graph_edge_index_remove(G, edge);
+            adjacent_unlink(&from->first, &from->last, p);
+            slab_free(&G->edges, edge);
+            from->D--;
+            G->nE--;
         }
+        Inbound_Node *temp = p->inbound_first;
+        p->inbound_first = temp->next;
+        slab_free(&G->inbound, temp);
+    }
+    graph_index_remove(G, p);
+    graph_clear_ranked(G);
+    graph_clear_paths(G);
+    if (p->prev) {
+        p->prev->next = p->next;
+    } else {
+        G->first = p->next;
     }
+    if (p->next) {
+        p->next->prev = p->prev;
+    } else {
+        G->last = p->prev;
+    }
+    // an owned value stays in the names slab until the graph is destroyed
+    slab_free(&G->vertices, p);
+    G->nV--;
 }
 
 size_t graph_vertices_count (graph G) {
@@ -435,174 +765,114 @@ size_t graph_vertices_count (graph G) {
 
 // edge interface
 
+// This function is to add an edge from p to p2 unless they are already linked.
+void vertex_link (graph G, Vertex_Node *p, Vertex_Node *p2, size_t weight) {
+    // the edge is only added if it is not existed.
+    if (!graph_find_adjacent(G, p, p2)) {
+        vertex_add_Adjacent_Node(G, p, p2, weight);
+    }
+}
+
 void graph_add_edge (graph G, string vertex1, string vertex2, size_t weight) {
     if (!G) return;
-    // These two 'if' expression below is to add the vertex to the graph if it does not exist in the graph
-    if (!graph_has_vertex(G, vertex1)) graph_add_vertex(G, vertex1);
-    if (!graph_has_vertex(G, vertex2)) graph_add_vertex(G, vertex2);
-    // This temporary p is to find the location of vertex1
-    Vertex_Node *p = G->first;
-    while (p) {
-        // vertex1 is located when the expression is true
-        if (strcmp(p->data, vertex1) == 0) {
-            Adjacent_Node *temp = p->first;
-            if (!temp) {
-                vertex_add_Adjacent_Node(G, p, vertex2, temp, weight);
-                return;
-            } else {
-                // this is to find if the edge is existed.
-                while (temp) {
-                    if (strcmp(temp->v_node->data, vertex2) == 0) {
-                        return;
-                    } else {
-                        // the edge is not existed, therefore, we add an adjacent node to this list
-                        if (!temp->next) {
-                            vertex_add_Adjacent_Node(G, p, vertex2, temp, weight);
-                            return;
-                        } else {
-                            temp = temp->next;
-                        }
-                    }
-                }
-            }
-        } else {
-            p = p->next;
-        }
+    // the vertices are added to the graph if they do not exist in the graph
+    Vertex_Node *p = graph_intern_vertex(G, vertex1, strlen(vertex1));
+    Vertex_Node *p2 = graph_intern_vertex(G, vertex2, strlen(vertex2));
+    if (!p || !p2) return;
+    vertex_link(G, p, p2, weight);
+}
+
+void graph_add_edge_bytes (graph G, const char *vertex1, size_t len1, const char *vertex2, size_t len2, size_t weight) {
+    if (!G) return;
+    Vertex_Node *p = graph_intern_vertex(G, vertex1, len1);
+    Vertex_Node *p2 = graph_intern_vertex(G, vertex2, len2);
+    if (!p || !p2) return;
+    vertex_link(G, p, p2, weight);
+}
+
+// This function is to find the adjacent node of the edge between two vertices, NULL if it does not exist.
+Adjacent_Node *graph_find_edge (graph G, string vertex1, string vertex2) {
+    Vertex_Node *p = graph_find_vertex(G, vertex1);
+    if (!p) return NULL;
+    Vertex_Node *p2 = graph_find_vertex(G, vertex2);
+    if (!p2) return NULL;
+    return graph_find_adjacent(G, p, p2);
+}
+
+// This function is to add one to the weight of the edge from p to p2, adding an edge of weight 1 if it does not exist.
+void vertex_increment (graph G, Vertex_Node *p, Vertex_Node *p2) {
+    Adjacent_Node *temp = graph_find_adjacent(G, p, p2);
+    if (temp) {
+        temp->weight++;
+        graph_clear_paths(G);
+    } else {
+        vertex_add_Adjacent_Node(G, p, p2, 1);
     }
 }
 
+void graph_increment_edge (graph G, string vertex1, string vertex2) {
+    if (!G) return;
+    Vertex_Node *p = graph_intern_vertex(G, vertex1, strlen(vertex1));
+    Vertex_Node *p2 = graph_intern_vertex(G, vertex2, strlen(vertex2));
+    if (!p || !p2) return;
+    vertex_increment(G, p, p2);
+}
+
+void graph_increment_edge_ids (graph G, size_t id1, size_t id2) {
+    if (!G || !G->pool) return;
+    Vertex_Node *p = graph_intern_id(G, id1);
+    Vertex_Node *p2 = graph_intern_id(G, id2);
+    if (!p || !p2) return;
+    vertex_increment(G, p, p2);
+}
+
 bool graph_has_edge (graph G, string vertex1, string vertex2) {
     if(!G) return false;
-    if (G->first) {
-        Vertex_Node *p = G->first;
-        while (p) {
-            if (strcmp(p->data, vertex1) == 0) {
-                Adjacent_Node *temp = p->first;
-                while (temp && strcmp(temp->v_node->data, vertex2) != 0) {
-                    temp = temp->next;
-                }
-                if (temp) {
-                    return true;
-                } else {
-                    return false;
-                }
-            } else {
-                p = p->next;
-            }
-        }
-    }
-    return false;
+    return graph_find_edge(G, vertex1, vertex2) != NULL;
 }
 
 size_t graph_remove_edge (graph G, string vertex1, string vertex2) {
     if (!G) return 0;
-    if (G->first) {
-        Vertex_Node *p = G->first;
-        while (p) {
-            if (p->first && strcmp(p->data, vertex1) == 0) {
-                if (!p->first->next && strcmp(p->first->v_node->data, vertex2) == 0) {
-                    Adjacent_Node *temp = p->first;
-                    vertex_remove_inbound_node(G, p, vertex2);
-                    p->first = NULL;
-                    size_t data = temp->weight;
-                    free(temp);
-                    G->nE--;
-                    p->D--;
-                    return data;
-                } else if (!p->first->next && strcmp(p->first->v_node->data, vertex2) != 0) {
-                    return 0;
-                }
-                Adjacent_Node *curr = p->first;
-                Adjacent_Node *next = p->first->next;
-                while (next) {
-                    if (strcmp(next->v_node->data, vertex2) == 0) {
-                        curr->next = next->next;
-                        size_t data = next->weight;
-                        vertex_remove_inbound_node(G, p, vertex2);
-                        free(next);
-                        G->nE--;
-                        p->D--;
-                        return data;
-                    } else {
-                        curr = curr->next;
-                        next = next->next;
-                    }
-                }
-            } else {
-                p = p->next;
-            }
-        }
-    }
-    return 0;
+    Vertex_Node *p = graph_find_vertex(G, vertex1);
+    if (!p) return 0;
+    Vertex_Node *p2 = graph_find_vertex(G, vertex2);
+    if (!p2) return 0;
+    Adjacent_Node *temp = graph_find_adjacent(G, p, p2);
+    if (!temp) return 0;
+    graph_edge_index_remove(G, temp);
+    adjacent_unlink(&p->first, &p->last, p2);
+    size_t data = temp->weight;
+    vertex_remove_inbound_node(G, p, p2);
+    slab_free(&G->edges, temp);
+    G->nE--;
+    p->D--;
+    graph_clear_paths(G);
+    return data;
 }
 
 void graph_set_edge (graph G, string vertex1, string vertex2, size_t weight) {
     if (!G) return;
-    if (G->first) {
-        Vertex_Node *p = G->first;
-        while (p) {
-            if (strcmp(p->data, vertex1) == 0) {
-                Adjacent_Node *temp = p->first;
-                while (temp) {
-                    if (strcmp(temp->v_node->data, vertex2) == 0) {
-                        temp->weight = weight;
-                        return;
-                    } else {
-                        temp = temp->next;
-                    }
-                }
-                return;
-            } else {
-                p = p->next;
-            }
-        }
+    Adjacent_Node *temp = graph_find_edge(G, vertex1, vertex2);
+    if (temp) {
+        temp->weight = weight;
+        graph_clear_paths(G);
     }
 }
 
 size_t graph_get_edge (graph G, string vertex1, string vertex2) {
     if (!G) return 0;
-    if (G->first) {
-        Vertex_Node *p = G->first;
-        while (p) {
-            if (p->first && strcmp(p->data, vertex1) == 0) {
-                Adjacent_Node *temp = p->first;
-                while (temp && strcmp(temp->v_node->data, vertex2) != 0) {
-                    temp = temp->next;
-                }
-                if (temp) {
-                    return temp->weight;
-                }
-            } else {
-                p = p->next;
-            }
-        }
+    Adjacent_Node *temp = graph_find_edge(G, vertex1, vertex2);
+    if (temp) {
+        return temp->weight;
     }
     return 0;
 }
 
 size_t graph_edges_count (graph G, string vertex) {
     if (!G) return 0;
-    if (G->first) {
-        Vertex_Node *p = G->first;
-        while (p) {
-            if (strcmp(p->data, vertex) == 0) {
-                if (!p->first) {
-                    return 0;
-                } else {
-                    size_t count = 1;
-                    Adjacent_Node *temp = p->first;
-                    while (temp) {
-                        count++;
-                        temp = temp->next;
-                    }
-                    return count;
-                }
-            } else {
-                p = p->next;
-            }
-        }
-    }
-    return 0;
+    Vertex_Node *p = graph_find_vertex(G, vertex);
+    if (!p) return 0;
+    return p->D;
 }
 
 void graph_pagerank(graph G, double damping, double delta) {
@@ -632,7 +902,7 @@ void graph_pagerank(graph G, double damping, double delta) {
         p = G->first; // This temporary pointer is to update the pagerank by sink_rank
         while (p) {
             p->pagerank = sink_rank + ((1-damping)/N);
-            Adjacent_Node *adj = p->inbound_first;
+            Inbound_Node *adj = p->inbound_first;
             while (adj) {
                 double D = adj->v_node->D; // convert data type from size_t to double
                 p->pagerank = p->pagerank + ((damping * adj->v_node->oldrank)/D);
@@ -641,100 +911,884 @@ void graph_pagerank(graph G, double damping, double delta) {
             p = p->next;
         }
     }
-    graph_sorted(G, delta);
+    graph_clear_ranked(G);
+    G->rank_epsilon = delta;
+}
+
+void graph_pagerank_csr(graph G, double damping, double delta, size_t n_threads) {
+    if (!G || !G->nV) return;
+    csr C = graph_freeze(G);
+    if (!C) return;
+    double *ranks = malloc(C->nV * sizeof(double));
+    if (!ranks) {
+        csr_destroy(C);
+        return;
+    }
+    csr_pagerank_parallel(C, damping, delta, ranks, n_threads);
+    // the snapshot numbered the vertices in list order, so the ranks can be copied back in one walk
+    Vertex_Node *p = G->first;
+    for (size_t v = 0; p; v++, p = p->next) {
+        p->pagerank = ranks[v];
+    }
+    free(ranks);
+    csr_destroy(C);
+    graph_clear_ranked(G);
+    G->rank_epsilon = delta;
 }
 
 void graph_viewrank(graph G, FILE *file) {
     if (!file) {
         file = stdout;
     }
-    Vertex_Node *p = G->first;
-    while (p) {
-        fprintf(file, "%s (%.3f)\n", p->data, p->pagerank);
-        p = p->next;
+    if (!G->ranked) {
+        graph_build_ranked(G);
+        if (!G->ranked) return;
+    }
+    for (int i = 0; i < G->nV; i++) {
+        fprintf(file, "%s (%.3f)\n", G->ranked[i]->data, G->ranked[i]->pagerank);
     }
 }
 
-void graph_shortest_path(graph G, string source) {
-    if (!G) return;
-    if(!G->first->next) return;
+void graph_viewrank_top(graph G, size_t k, FILE *file) {
+    if (!file) {
+        file = stdout;
+    }
+    if (!G || !k) return;
+    // every vertex is printed, so the heap would only sort them all more slowly than the full view
+    if (k >= (size_t) G->nV && !G->ranked) graph_build_ranked(G);
+    if (G->ranked) {
+        for (size_t i = 0; i < k && i < (size_t) G->nV; i++) {
+            fprintf(file, "%s (%.3f)\n", G->ranked[i]->data, G->ranked[i]->pagerank);
+        }
+        return;
+    }
+    if (k > (size_t) G->nV) k = G->nV;
+    Ranked_Entry *heap = malloc(k * sizeof(*heap));
+    if (!heap) return;
+    // keep the k vertices that come first, with the one that comes last among them at the root
+    size_t n = 0, order = 0;
+    for (Vertex_Node *p = G->first; p; p = p->next, order++) {
+        Ranked_Entry entry = { p, order };
+        if (n < k) {
+            heap[n] = entry;
+            ranked_heap_sift_up(heap, n++, G->rank_epsilon);
+        } else if (ranked_entry_after(&heap[0], &entry, G->rank_epsilon)) {
+            heap[0] = entry;
+            ranked_heap_sift_down(heap, n, 0, G->rank_epsilon);
+        }
+    }
+    // popping the root moves the last of the remaining entries behind them, which leaves the heap in rank order
+    while (n > 1) {
+        Ranked_Entry temp = heap[0];
+        heap[0] = heap[--n];
+        heap[n] = temp;
+        ranked_heap_sift_down(heap, n, 0, G->rank_epsilon);
+    }
+    for (size_t i = 0; i < k; i++) {
+        fprintf(file, "%s (%.3f)\n", heap[i].vertex->data, heap[i].vertex->pagerank);
+    }
+    free(heap);
+}
 
-    // Create a queue for the nodes
-    list queue = list_create();
-    Vertex_Node *p = G->first;
+//=====================================compressed sparse row snapshot===================================================
+
+csr graph_freeze (graph G) {
+    if (!G) return NULL;
+    csr C = malloc(sizeof(*C));
+    if (!C) return NULL;
+    size_t nV = G->nV;
+    size_t nE = G->nE;
 
-    // This is to find the position of source node, and mark it as source.
-    while (p && strcmp(p->data, source) != 0) {
+    // number the vertices in iteration order, the edges are already counted
+    size_t id = 0;
+    Vertex_Node *p = G->first;
+    while (p) {
+        p->id = id++;
         p = p->next;
     }
-    if (p) {
-        p->source = true;
-        p->dist = 0;
-        Adjacent_Node *adj = p->first;
+    C->nV = nV;
+    C->nE = nE;
+    C->n_slots = 1;
+    while (C->n_slots < 2 * nV) {
+        C->n_slots *= 2;
+    }
+    C->names = malloc(nV * sizeof(*C->names));
+    C->out_offsets = malloc((nV + 1) * sizeof(size_t));
+    C->out_targets = malloc(nE * sizeof(size_t));
+    C->out_weights = malloc(nE * sizeof(size_t));
+    C->in_offsets = calloc(nV + 1, sizeof(size_t));
+    C->in_sources = malloc(nE * sizeof(size_t));
+    C->in_weights = malloc(nE * sizeof(size_t));
+    C->index = calloc(C->n_slots, sizeof(size_t));
+    if (!C->names || !C->out_offsets || !C->out_targets || !C->out_weights
+        || !C->in_offsets || !C->in_sources || !C->in_weights || !C->index) {
+        csr_destroy(C);
+        return NULL;
+    }
 
-        // This while loop is to initialize and enqueue all the nodes which have been pointed from the source node
+    // outbound rows, in adjacency list order
+    size_t e = 0;
+    p = G->first;
+    while (p) {
+        C->names[p->id] = p->data;
+        C->out_offsets[p->id] = e;
+        size_t slot = p->hash & (C->n_slots - 1);
+        while (C->index[slot]) {
+            slot = (slot + 1) & (C->n_slots - 1);
+        }
+        C->index[slot] = p->id + 1;
+        Adjacent_Node *adj = p->first;
         while (adj) {
-            graph_dijkstra_enqueue(queue, adj->v_node);
-            adj->v_node->pred = p;
-            adj->v_node->dist = 1;
-            adj->v_node->visited = true;
+            C->out_targets[e] = adj->v_node->id;
+            C->out_weights[e] = adj->weight;
+            C->in_offsets[adj->v_node->id + 1]++;
+            e++;
             adj = adj->next;
         }
+        p = p->next;
+    }
+    C->out_offsets[nV] = e;
+
+    // inbound rows, the transpose of the outbound rows, ordered by source id
+    for (size_t v = 0; v < nV; v++) {
+        C->in_offsets[v + 1] += C->in_offsets[v];
+    }
+    size_t *fill = malloc((nV + 1) * sizeof(size_t));
+    if (!fill) {
+        csr_destroy(C);
+        return NULL;
+    }
+    memcpy(fill, C->in_offsets, (nV + 1) * sizeof(size_t));
+    for (size_t u = 0; u < nV; u++) {
+        for (size_t i = C->out_offsets[u]; i < C->out_offsets[u + 1]; i++) {
+            size_t slot = fill[C->out_targets[i]]++;
+            C->in_sources[slot] = u;
+            C->in_weights[slot] = C->out_weights[i];
+        }
+    }
+    free(fill);
+    return C;
+}
+
+void csr_destroy (csr C) {
+    if (!C) return;
+    free(C->names);
+    free(C->out_offsets);
+    free(C->out_targets);
+    free(C->out_weights);
+    free(C->in_offsets);
+    free(C->in_sources);
+    free(C->in_weights);
+    free(C->index);
+    free(C);
+}
+
+size_t csr_find (csr C, string vertex) {
+    if (!C || !C->nV) return 0;
+    size_t slot = hash_string(vertex) & (C->n_slots - 1);
+    while (C->index[slot]) {
+        size_t id = C->index[slot] - 1;
+        if (strcmp(C->names[id], vertex) == 0) return id;
+        slot = (slot + 1) & (C->n_slots - 1);
+    }
+    return C->nV;
+}
+
+// the arrays one PageRank computation over a snapshot iterates on, shared by every thread working on it
+typedef struct PageRank_State {
+    csr C;
+    double damping;
+    double *ranks;
+    // contrib[u] is the rank u passes along each of its outbound edges, sink_share[u] what it spreads over all vertices
+    double *scale;
+    double *sink_share;
+    double *contrib;
+    double *next_contrib;
+    double sink_rank;
+} PageRank_State;
+
+// one thread's vertex range and its share of the reductions
+typedef struct PageRank_Part {
+    struct PageRank_Pool *pool;
+    size_t start;
+    size_t end;
+    double sink_rank;
+    double max_diff;
+} PageRank_Part;
+
+// the threads of one parallel computation, which meet at the barrier twice per iteration
+typedef struct PageRank_Pool {
+    PageRank_State *state;
+    pthread_mutex_t gate;
+    pthread_barrier_t barrier;
+    double delta;
+    bool accepted;
+    PageRank_Part *parts;
+    size_t n_parts;
+} PageRank_Pool;
+
+bool pagerank_state_init(PageRank_State *S, csr C, double damping, double *ranks) {
+    size_t nV = C->nV;
+    double N = nV;
+    S->C = C;
+    S->damping = damping;
+    S->ranks = ranks;
+    S->scale = malloc(nV * sizeof(double));
+    S->sink_share = malloc(nV * sizeof(double));
+    S->contrib = malloc(nV * sizeof(double));
+    S->next_contrib = malloc(nV * sizeof(double));
+    if (!S->scale || !S->sink_share || !S->contrib || !S->next_contrib) return false;
+    S->sink_rank = 0;
+    for (size_t v = 0; v < nV; v++) {
+        size_t D = C->out_offsets[v + 1] - C->out_offsets[v];
+        S->scale[v] = D ? damping / D : 0;
+        S->sink_share[v] = D ? 0 : damping / N;
+        ranks[v] = 1 / N;
+        S->contrib[v] = ranks[v] * S->scale[v];
+        S->sink_rank += ranks[v] * S->sink_share[v];
+    }
+    return true;
+}
+
+void pagerank_state_free(PageRank_State *S) {
+    free(S->scale);
+    free(S->sink_share);
+    free(S->contrib);
+    free(S->next_contrib);
+}
 
-        // This is to start the Dijkstra algorithm, for these nodes have been visited, we will compare the path value,
-        // for these nodes have not been visited, we will add it to the queue.
-        // After the queue become empty, all nodes' dist and pred will be identified.
-        while (queue->length) {
-            Vertex_Node *vertex = graph_dijkstra_dequeue(queue);
-            size_t curr_dist = vertex->dist;
-            if (vertex->first) {
-                Adjacent_Node *adj2 = vertex->first;
-                while (adj2) {
-                    if (!adj2->v_node->source && curr_dist < adj2->v_node->dist) {
-                        adj2->v_node->dist = curr_dist++;
-                        adj2->v_node->pred = vertex;
-                    }
-                    if (!adj2->v_node->visited) {
-                        adj2->v_node->visited = true;
-                        graph_dijkstra_enqueue(queue, adj2->v_node);
-                    }
-                    adj2 = adj2->next;
-                }
+// after every range has been updated, make the new contributions and sink rank current
+void pagerank_state_advance(PageRank_State *S, double sink_rank) {
+    double *temp = S->contrib;
+    S->contrib = S->next_contrib;
+    S->next_contrib = temp;
+    S->sink_rank = sink_rank;
+}
+
+// one pass over [start, end) computes the new ranks, the largest change, and the sink rank and contributions for the next pass
+void pagerank_update_range(PageRank_State *S, size_t start, size_t end, double *sink_rank, double *max_diff) {
+    csr C = S->C;
+    const double *contrib = S->contrib;
+    double base = S->sink_rank + ((1 - S->damping) / C->nV);
+    double next_sink_rank = 0;
+    double largest = 0;
+    for (size_t v = start; v < end; v++) {
+        double sum = 0;
+        for (size_t i = C->in_offsets[v]; i < C->in_offsets[v + 1]; i++) {
+            sum += contrib[C->in_sources[i]];
+        }
+        double rank = base + sum;
+        double diff = fabs(rank - S->ranks[v]);
+        largest = diff > largest ? diff : largest;
+        S->ranks[v] = rank;
+        S->next_contrib[v] = rank * S->scale[v];
+        next_sink_rank += rank * S->sink_share[v];
+    }
+    *sink_rank = next_sink_rank;
+    *max_diff = largest;
+}
+
+void csr_pagerank (csr C, double damping, double delta, double *ranks) {
+    if (!C || !C->nV) return;
+    PageRank_State S;
+    if (!pagerank_state_init(&S, C, damping, ranks)) {
+        pagerank_state_free(&S);
+        return;
+    }
+    // like is_differ_accepted, the first test compares the initial ranks against zero
+    bool accepted = (1.0 / C->nV) <= delta;
+    while (!accepted) {
+        double sink_rank, max_diff;
+        pagerank_update_range(&S, 0, C->nV, &sink_rank, &max_diff);
+        pagerank_state_advance(&S, sink_rank);
+        accepted = max_diff <= delta;
+    }
+    pagerank_state_free(&S);
+}
+
+// every thread runs the same iterations on its own range, one of them reduces the results in between
+void *pagerank_worker(void *arg) {
+    PageRank_Part *part = arg;
+    PageRank_Pool *pool = part->pool;
+    pthread_mutex_lock(&pool->gate);
+    pthread_mutex_unlock(&pool->gate);
+    for (;;) {
+        pthread_barrier_wait(&pool->barrier);
+        if (pool->accepted) break;
+        pagerank_update_range(pool->state, part->start, part->end, &part->sink_rank, &part->max_diff);
+        if (pthread_barrier_wait(&pool->barrier) == PTHREAD_BARRIER_SERIAL_THREAD) {
+            double sink_rank = 0;
+            double max_diff = 0;
+            for (size_t i = 0; i < pool->n_parts; i++) {
+                sink_rank += pool->parts[i].sink_rank;
+                max_diff = pool->parts[i].max_diff > max_diff ? pool->parts[i].max_diff : max_diff;
             }
+            pagerank_state_advance(pool->state, sink_rank);
+            pool->accepted = max_diff <= pool->delta;
         }
     }
-    graph_dijkstra_destroy(queue);
+    return NULL;
 }
 
-void graph_view_path(graph G, string destination) {
-    if (!G) return;
-    list stack = list_create();
-    Vertex_Node *p = G->first;
-    while (p && strcmp(destination, p->data) != 0) {
-        p = p->next;
+void csr_pagerank_parallel (csr C, double damping, double delta, double *ranks, size_t n_threads) {
+    if (!C || !C->nV) return;
+    if (n_threads > C->nV) n_threads = C->nV;
+    if (n_threads <= 1) {
+        csr_pagerank(C, damping, delta, ranks);
+        return;
+    }
+    PageRank_State S;
+    PageRank_Pool pool = { .state = &S, .gate = PTHREAD_MUTEX_INITIALIZER, .delta = delta };
+    bool ready = pagerank_state_init(&S, C, damping, ranks);
+    pool.parts = malloc(n_threads * sizeof(PageRank_Part));
+    pthread_t *threads = malloc(n_threads * sizeof(pthread_t));
+    if (!ready || !pool.parts || !threads) {
+        free(pool.parts);
+        free(threads);
+        pagerank_state_free(&S);
+        return;
+    }
+
+    // the workers wait on the gate until it is known how many of them could be started
+    pthread_mutex_lock(&pool.gate);
+    pool.parts[0].pool = &pool;
+    pool.n_parts = 1;
+    while (pool.n_parts < n_threads) {
+        pool.parts[pool.n_parts].pool = &pool;
+        if (pthread_create(&threads[pool.n_parts], NULL, pagerank_worker, &pool.parts[pool.n_parts]) != 0) break;
+        pool.n_parts++;
+    }
+    // split the vertices so every range has about the same number of vertices plus inbound edges to read
+    size_t work = C->nV + C->nE;
+    size_t v = 0;
+    for (size_t i = 0; i < pool.n_parts; i++) {
+        size_t target = work / pool.n_parts * (i + 1);
+        pool.parts[i].start = v;
+        if (i == pool.n_parts - 1) {
+            v = C->nV;
+        } else {
+            while (v < C->nV && v + C->in_offsets[v] < target) v++;
+        }
+        pool.parts[i].end = v;
+    }
+    pool.accepted = (1.0 / C->nV) <= delta;
+    pthread_barrier_init(&pool.barrier, NULL, pool.n_parts);
+    pthread_mutex_unlock(&pool.gate);
+
+    pagerank_worker(&pool.parts[0]);
+    for (size_t i = 1; i < pool.n_parts; i++) pthread_join(threads[i], NULL);
+
+    pthread_barrier_destroy(&pool.barrier);
+    pagerank_state_free(&S);
+    free(pool.parts);
+    free(threads);
+}
+
+// define an entry of the heap used when the weights are too large for a bucket queue
+typedef struct Dist_Entry {
+    size_t dist;
+    size_t vertex;
+} Dist_Entry;
+
+// define the state of a search over a snapshot, which every search after the first reuses without clearing it
+typedef struct Search_State {
+    csr C;
+    const size_t *offsets; // the rows the search follows, the outbound ones or, searching backwards, the inbound ones
+    const size_t *targets;
+    const size_t *weights;
+    size_t *dist; // the distance from the source, only meaningful for a vertex stamped with the current epoch
+    size_t *pred; // the vertex before it on the path, nV for the source, likewise only meaningful when stamped
+    unsigned *stamp; // the epoch of the search which last reached the vertex
+    unsigned epoch; // moving to the next epoch forgets every vertex the previous search reached
+    size_t *queue; // the breadth first frontier, or the next vertex in the same bucket for Dijkstra
+    size_t head, tail; // the part of queue still to be expanded by a breadth first search
+    size_t *prev; // the previous vertex in the same bucket, nV for the first
+    size_t *heads; // the first vertex of each bucket, nV for an empty bucket
+    size_t n_buckets; // one more than the largest weight, so the waiting distances never share a bucket, 0 to use heap
+    size_t queued; // the number of vertices waiting to be expanded
+    size_t cursor; // the distance of the next vertices to be expanded
+    struct Dist_Entry *heap; // the frontier used instead of the buckets for weights of DIAL_MAX_BUCKETS or more
+} Search_State;
+
+// This function is to free the arrays of a search state.
+void search_state_free (Search_State *S) {
+    free(S->dist);
+    free(S->pred);
+    free(S->stamp);
+    free(S->queue);
+    free(S->prev);
+    free(S->heads);
+    free(S->heap);
+}
+
+// This function is to allocate everything a search over C needs, so that the searches themselves allocate nothing,
+// a backward search follows the inbound edges, to find the distances to the source instead of from it.
+bool search_state_init (Search_State *S, csr C, bool backward) {
+    size_t max_weight = 0;
+    for (size_t e = 0; e < C->nE; e++) {
+        if (C->out_weights[e] > max_weight) max_weight = C->out_weights[e];
+    }
+    S->C = C;
+    S->offsets = backward ? C->in_offsets : C->out_offsets;
+    S->targets = backward ? C->in_sources : C->out_targets;
+    S->weights = backward ? C->in_weights : C->out_weights;
+    S->epoch = 0;
+    S->queued = S->cursor = S->head = S->tail = 0;
+    S->n_buckets = max_weight < DIAL_MAX_BUCKETS ? max_weight + 1 : 0;
+    S->dist = malloc(C->nV * sizeof(size_t));
+    S->pred = malloc(C->nV * sizeof(size_t));
+    S->stamp = calloc(C->nV, sizeof(unsigned));
+    S->queue = malloc(C->nV * sizeof(size_t));
+    S->prev = malloc(C->nV * sizeof(size_t));
+    S->heads = S->n_buckets ? malloc(S->n_buckets * sizeof(size_t)) : NULL;
+    // a vertex is pushed onto the heap at most once for every edge into it, and once as the source
+    S->heap = S->n_buckets ? NULL : malloc((C->nE + 1) * sizeof(Dist_Entry));
+    if ((C->nV && (!S->dist || !S->pred || !S->stamp || !S->queue || !S->prev)) || (!S->heads && !S->heap)) {
+        search_state_free(S);
+        return false;
+    }
+    return true;
+}
+
+// This function is to tell if vertex v has been reached by the current search.
+bool search_reached (const Search_State *S, size_t v) {
+    return S->stamp[v] == S->epoch;
+}
+
+// This function is to record that vertex v is dist away from the source, through pred.
+void search_reach (Search_State *S, size_t v, size_t dist, size_t pred) {
+    S->stamp[v] = S->epoch;
+    S->dist[v] = dist;
+    S->pred[v] = pred;
+}
+
+// This function is to forget the previous search in constant time, and reach the source.
+void search_begin (Search_State *S, size_t source) {
+    if (++S->epoch == 0) {
+        // once every 4 billion searches the stamps wrap around and have to be cleared for real
+        memset(S->stamp, 0, S->C->nV * sizeof(unsigned));
+        S->epoch = 1;
+    }
+    search_reach(S, source, 0, S->C->nV);
+}
+
+// This function is to record in *best and *meet the path through v, if the other search of a bidirectional one has reached it
+// and the path is shorter than the best so far.
+void search_meet (const Search_State *S, const Search_State *other, size_t v, size_t *best, size_t *meet) {
+    if (other && search_reached(other, v) && S->dist[v] + other->dist[v] < *best) {
+        *best = S->dist[v] + other->dist[v];
+        *meet = v;
+    }
+}
+
+// This function is to start a breadth first search, with only the source in the frontier.
+void bfs_begin (Search_State *S, size_t source) {
+    search_begin(S, source);
+    // every vertex enters the frontier at most once, so one array of nV ids holds the whole queue
+    S->head = S->tail = 0;
+    S->queue[S->tail++] = source;
+    S->queued = 1;
+    S->cursor = 0;
+}
+
+// This function is to expand every vertex of the frontier at the cursor's distance, which puts the next level behind them.
+void bfs_level (Search_State *S, const Search_State *other, size_t *best, size_t *meet) {
+    size_t end = S->tail;
+    while (S->head < end) {
+        size_t u = S->queue[S->head++];
+        for (size_t i = S->offsets[u]; i < S->offsets[u + 1]; i++) {
+            size_t v = S->targets[i];
+            if (!search_reached(S, v)) {
+                search_reach(S, v, S->dist[u] + 1, u);
+                S->queue[S->tail++] = v;
+            }
+            search_meet(S, other, v, best, meet);
+        }
+    }
+    S->queued = S->tail - S->head;
+    S->cursor++;
+}
+
+// This function is to find the fewest hops from source to every vertex, breadth first.
+void search_hops (Search_State *S, size_t source) {
+    bfs_begin(S, source);
+    while (S->queued) {
+        bfs_level(S, NULL, NULL, NULL);
+    }
+}
+
+// This function is to add vertex v to bucket b.
+void dial_push (Search_State *S, size_t b, size_t v) {
+    size_t nil = S->C->nV;
+    S->prev[v] = nil;
+    S->queue[v] = S->heads[b];
+    if (S->heads[b] != nil) S->prev[S->heads[b]] = v;
+    S->heads[b] = v;
+    S->queued++;
+}
+
+// This function is to take vertex v out of bucket b.
+void dial_remove (Search_State *S, size_t b, size_t v) {
+    size_t nil = S->C->nV;
+    if (S->prev[v] != nil) {
+        S->queue[S->prev[v]] = S->queue[v];
+    } else {
+        S->heads[b] = S->queue[v];
+    }
+    if (S->queue[v] != nil) S->prev[S->queue[v]] = S->prev[v];
+    S->queued--;
+}
+
+// This function is to start a search with a bucket queue (Dial's algorithm), with only the source waiting.
+void dial_begin (Search_State *S, size_t source) {
+    for (size_t b = 0; b < S->n_buckets; b++) {
+        S->heads[b] = S->C->nV;
+    }
+    S->queued = 0;
+    S->cursor = 0;
+    search_begin(S, source);
+    dial_push(S, 0, source);
+}
+
+// This function is to move the cursor to the nearest distance with a vertex waiting, return False once none is waiting.
+bool dial_next (Search_State *S) {
+    if (!S->queued) return false;
+    while (S->heads[S->cursor % S->n_buckets] == S->C->nV) {
+        S->cursor++;
     }
-    if (p) {
-        list_push(stack, p->data);
-        Vertex_Node *p2 = p->pred;
-        while (!p2->source) {
-            list_push(stack, p2->data);
-            p2 = p2->pred;
+    return true;
+}
+
+// This function is to settle every vertex at the cursor's distance and relax its edges.
+void dial_settle (Search_State *S, const Search_State *other, size_t *best, size_t *meet) {
+    // every waiting distance lies in [cursor, cursor + max weight], so the cursor's bucket holds exactly the vertices at that distance
+    size_t b = S->cursor % S->n_buckets;
+    while (S->heads[b] != S->C->nV) {
+        size_t u = S->heads[b];
+        dial_remove(S, b, u);
+        for (size_t e = S->offsets[u]; e < S->offsets[u + 1]; e++) {
+            size_t v = S->targets[e];
+            size_t through = S->cursor + S->weights[e];
+            bool reached = search_reached(S, v);
+            if (!reached || through < S->dist[v]) {
+                if (reached) dial_remove(S, S->dist[v] % S->n_buckets, v);
+                search_reach(S, v, through, u);
+                dial_push(S, through % S->n_buckets, v);
+            }
+            search_meet(S, other, v, best, meet);
         }
-        if (p2->source) {
-            list_push(stack, p2->data);
+    }
+    S->cursor++;
+}
+
+// This function is to find the least total weight from source to every vertex with a bucket queue.
+void search_dial (Search_State *S, size_t source) {
+    dial_begin(S, source);
+    while (dial_next(S)) {
+        dial_settle(S, NULL, NULL, NULL);
+    }
+}
+
+// This function is to find the least total weight from source to every vertex with a binary heap,
+// where an entry superseded by a shorter distance is skipped when it is popped.
+void search_heap (Search_State *S, size_t source) {
+    Dist_Entry *heap = S->heap;
+    size_t n = 0;
+    search_begin(S, source);
+    heap[n++] = (Dist_Entry) {0, source};
+    while (n) {
+        Dist_Entry top = heap[0];
+        heap[0] = heap[--n];
+        for (size_t i = 0, child; (child = 2 * i + 1) < n; i = child) {
+            if (child + 1 < n && heap[child + 1].dist < heap[child].dist) child++;
+            if (heap[i].dist <= heap[child].dist) break;
+            Dist_Entry temp = heap[i];
+            heap[i] = heap[child];
+            heap[child] = temp;
         }
+        size_t u = top.vertex;
+        if (top.dist > S->dist[u]) continue;
+        for (size_t e = S->offsets[u]; e < S->offsets[u + 1]; e++) {
+            size_t v = S->targets[e];
+            size_t through = S->dist[u] + S->weights[e];
+            if (search_reached(S, v) && through >= S->dist[v]) continue;
+            search_reach(S, v, through, u);
+            size_t i = n++;
+            heap[i] = (Dist_Entry) {through, v};
+            while (i && heap[(i - 1) / 2].dist > heap[i].dist) {
+                Dist_Entry temp = heap[i];
+                heap[i] = heap[(i - 1) / 2];
+                heap[(i - 1) / 2] = temp;
+                i = (i - 1) / 2;
+            }
+        }
+    }
+}
+
+// This function is to find the least total weight from source to every vertex, with whichever frontier the weights allow.
+void search_weighted (Search_State *S, size_t source) {
+    if (S->n_buckets) {
+        search_dial(S, source);
     } else {
-        return;
+        search_heap(S, source);
+    }
+}
+
+// This function is to find a shortest path from source to target by searching forwards from the source and backwards from the target,
+// a level or a bucket at a time on whichever side has fewer vertices waiting, and return the vertex where the two meet, nV if there is no path.
+size_t search_between (Search_State *F, Search_State *B, size_t source, size_t target, bool hops) {
+    size_t best = SIZE_MAX, meet = F->C->nV;
+    if (hops) {
+        bfs_begin(F, source);
+        bfs_begin(B, target);
+    } else {
+        dial_begin(F, source);
+        dial_begin(B, target);
     }
-    while (stack) {
-        string result = list_pop(stack);
-        if (stack->length >= 1) {
-            printf("%s -> ", result);
+    search_meet(F, B, source, &best, &meet);
+    // once the nearest waiting vertices on both sides are together as far as the best path, no path through them is shorter
+    while ((hops ? F->queued && B->queued : dial_next(F) && dial_next(B)) && F->cursor + B->cursor < best) {
+        Search_State *S = F->queued <= B->queued ? F : B;
+        Search_State *other = S == F ? B : F;
+        if (hops) {
+            bfs_level(S, other, &best, &meet);
         } else {
-            printf("%s\n", result);
-            list_destroy(stack);
-            return;
+            dial_settle(S, other, &best, &meet);
         }
     }
+    return meet;
+}
+
+// This function is to copy the result of a search out into plain arrays.
+void search_export (const Search_State *S, size_t *dist, size_t *pred) {
+    for (size_t v = 0; v < S->C->nV; v++) {
+        bool reached = search_reached(S, v);
+        dist[v] = reached ? S->dist[v] : SIZE_MAX;
+        pred[v] = reached ? S->pred[v] : S->C->nV;
+    }
+}
+
+bool csr_shortest_path (csr C, size_t source, size_t *dist, size_t *pred) {
+    if (!C || source >= C->nV) return false;
+    Search_State S;
+    if (!search_state_init(&S, C, false)) return false;
+    search_hops(&S, source);
+    search_export(&S, dist, pred);
+    search_state_free(&S);
+    return true;
+}
+
+bool csr_dijkstra (csr C, size_t source, size_t *dist, size_t *pred) {
+    if (!C || source >= C->nV) return false;
+    Search_State S;
+    if (!search_state_init(&S, C, false)) return false;
+    search_weighted(&S, source);
+    search_export(&S, dist, pred);
+    search_state_free(&S);
+    return true;
+}
+
+//=========================================path queries=================================================================
+
+// define a path query, a graph's snapshot shared with every other query and the search state of this query alone
+typedef struct Path_Query_Repr {
+    graph G;
+    struct Search_State search;
+    struct Search_State backward; // the search from the destination of a point to point query, allocated by the first
+    bool has_backward;
+    bool searched; // whether the last search found its source, so search holds paths to view
+    size_t target; // the only destination the last search answers for a point to point query, nV for every vertex
+    size_t meet; // where the two searches of a point to point query met, nV if the target cannot be reached
+} Path_Query_Repr;
+
+path_query path_query_create (graph G) {
+    if (!G) return NULL;
+    // the first query builds the snapshot, the lock keeps queries created on other threads from building it as well
+    pthread_mutex_lock(&G->paths_lock);
+    if (!G->paths) G->paths = graph_freeze(G);
+    csr C = G->paths;
+    pthread_mutex_unlock(&G->paths_lock);
+    if (!C) return NULL;
+    path_query Q = malloc(sizeof(*Q));
+    if (!Q) return NULL;
+    if (!search_state_init(&Q->search, C, false)) {
+        free(Q);
+        return NULL;
+    }
+    Q->G = G;
+    Q->has_backward = false;
+    Q->searched = false;
+    Q->target = Q->meet = C->nV;
+    return Q;
+}
+
+void path_query_destroy (path_query Q) {
+    if (!Q) return;
+    search_state_free(&Q->search);
+    if (Q->has_backward) search_state_free(&Q->backward);
+    free(Q);
+}
+
+// This function is to start a search from source to every vertex, return the id of the source, nV if it is not in the graph.
+size_t path_query_begin (path_query Q, string source) {
+    size_t s = csr_find(Q->search.C, source);
+    Q->searched = s < Q->search.C->nV;
+    Q->target = Q->search.C->nV;
+    return s;
+}
 
+bool path_query_shortest (path_query Q, string source) {
+    if (!Q) return false;
+    size_t s = path_query_begin(Q, source);
+    if (Q->searched) search_weighted(&Q->search, s);
+    return Q->searched;
+}
+
+bool path_query_hops (path_query Q, string source) {
+    if (!Q) return false;
+    size_t s = path_query_begin(Q, source);
+    if (Q->searched) search_hops(&Q->search, s);
+    return Q->searched;
+}
+
+// This function is to find a path from source to destination alone, meeting in the middle, by hops or by weight.
+bool path_query_between (path_query Q, string source, string destination, bool hops) {
+    if (!Q) return false;
+    csr C = Q->search.C;
+    size_t s = path_query_begin(Q, source);
+    size_t t = csr_find(C, destination);
+    if (!Q->searched || t >= C->nV) {
+        Q->searched = false;
+        return false;
+    }
+    if (!Q->has_backward) {
+        if (!search_state_init(&Q->backward, C, true)) {
+            Q->searched = false;
+            return false;
+        }
+        Q->has_backward = true;
+    }
+    Q->target = t;
+    if (hops || Q->search.n_buckets) {
+        Q->meet = search_between(&Q->search, &Q->backward, s, t, hops);
+    } else {
+        // weights too large for buckets are searched from the source alone, and the path meets the target at the target
+        search_heap(&Q->search, s);
+        Q->meet = search_reached(&Q->search, t) ? t : C->nV;
+        search_begin(&Q->backward, t);
+    }
+    return Q->meet < C->nV;
+}
+
+bool path_query_shortest_to (path_query Q, string source, string destination) {
+    return path_query_between(Q, source, destination, false);
+}
+
+bool path_query_hops_to (path_query Q, string source, string destination) {
+    return path_query_between(Q, source, destination, true);
+}
+
+// This function is to lay out the path to destination from the source of the last search, backwards, and return its length,
+// 0 if destination is not in the graph or cannot be reached.
+size_t path_query_trace (path_query Q, string destination) {
+    if (!Q || !Q->searched) return 0;
+    Search_State *S = &Q->search;
+    size_t nil = S->C->nV;
+    size_t v = csr_find(S->C, destination);
+    if (v >= nil) return 0;
+    size_t n = 0;
+    if (Q->target < nil) {
+        // a point to point query only answers for its target, from the meeting vertex on its path goes back to the target
+        if (v != Q->target || Q->meet >= nil) return 0;
+        Search_State *B = &Q->backward;
+        size_t after = 0;
+        for (size_t w = B->pred[Q->meet]; w < nil; w = B->pred[w]) {
+            after++;
+        }
+        n = after;
+        for (size_t w = B->pred[Q->meet]; w < nil; w = B->pred[w]) {
+            S->queue[--after] = w;
+        }
+        v = Q->meet;
+    } else if (!search_reached(S, v)) {
+        return 0;
+    }
+    // the frontier is not needed once the search is done, so it holds the path from the destination back to the source
+    for (; v < nil; v = S->pred[v]) {
+        S->queue[n++] = v;
+    }
+    return n;
+}
+
+size_t path_query_distance (path_query Q, string destination) {
+    if (!Q || !Q->searched) return SIZE_MAX;
+    Search_State *S = &Q->search;
+    size_t nil = S->C->nV;
+    size_t v = csr_find(S->C, destination);
+    if (v >= nil) return SIZE_MAX;
+    if (Q->target < nil) {
+        // the path of a point to point query is the forward search's part up to where they met and the backward search's after
+        if (v != Q->target || Q->meet >= nil) return SIZE_MAX;
+        return S->dist[Q->meet] + Q->backward.dist[Q->meet];
+    }
+    return search_reached(S, v) ? S->dist[v] : SIZE_MAX;
+}
+
+void path_query_view (path_query Q, string destination) {
+    size_t n = path_query_trace(Q, destination);
+    // nothing is printed for a destination which is not in the graph or cannot be reached from the source
+    if (!n) return;
+    Search_State *S = &Q->search;
+    while (n > 1) {
+        printf("%s -> ", S->C->names[S->queue[--n]]);
+    }
+    printf("%s\n", S->C->names[S->queue[0]]);
+}
+
+void path_query_write (path_query Q, string destination, writer W) {
+    size_t n = path_query_trace(Q, destination);
+    if (!n || !W) return;
+    Search_State *S = &Q->search;
+    while (n > 1) {
+        writer_string(W, S->C->names[S->queue[--n]]);
+        writer_bytes(W, " -> ", 4);
+    }
+    writer_string(W, S->C->names[S->queue[0]]);
+    writer_char(W, '\n');
+}
+
+// This function is to get the query behind the single query interface, creating it on first use.
+path_query graph_default_query (graph G) {
+    if (!G->query) G->query = path_query_create(G);
+    return G->query;
+}
+
+void graph_shortest_path(graph G, string source) {
+    if (!G) return;
+    path_query_shortest(graph_default_query(G), source);
+}
+
+void graph_shortest_hops(graph G, string source) {
+    if (!G) return;
+    path_query_hops(graph_default_query(G), source);
+}
+
+void graph_shortest_path_to(graph G, string source, string destination) {
+    if (!G) return;
+    path_query_shortest_to(graph_default_query(G), source, destination);
+}
+
+void graph_shortest_hops_to(graph G, string source, string destination) {
+    if (!G) return;
+    path_query_hops_to(graph_default_query(G), source, destination);
+}
+
+void graph_view_path(graph G, string destination) {
+    if (!G) return;
+    path_query_view(G->query, destination);
+}
+
+void graph_write_path(graph G, string destination, writer W) {
+    if (!G) return;
+    path_query_write(G->query, destination, W);
 }
@@ -12,6 +12,8 @@ typedef char *string;
 #include <stddef.h>
 #include <stdio.h>
 
+#include "intern.h"
+
 typedef struct Graph_Repr *graph;
 
 // meta interface
@@ -22,6 +24,13 @@ typedef struct Graph_Repr *graph;
  * return NULL on error
  */
 graph graph_create (void);
+/**
+ * graph_create_interned
+ * allocate a new graph whose vertex values are interned in the given pool instead of copied,
+ * the pool must outlive the graph, and values from the pool are found by address
+ * return NULL on error
+ */
+graph graph_create_interned (intern_pool pool);
 /**
  * graph_destroy
  * free all memory associated with a given graph
@@ -44,6 +53,29 @@ void graph_destroy (graph G);
  * Then the directed edges between each vertex along with the edge weight is printed
  */
 void graph_show (graph G, FILE *file);
+/**
+ * graph_save
+ * write the graph to the given file as a binary snapshot, which graph_read_snapshot turns back into the same graph
+ * The snapshot is laid out as:
+ *      an 8 byte magic number, "PRGRAPH" and a version byte of 1
+ *      the number of vertices, edges and bytes in the string table, as little endian 64 bit numbers
+ *      the string table, every vertex's value null terminated, in the order graph_show prints them
+ *      for each vertex in the same order, its number of edges, then the id of the target and the weight of each edge
+ * Where an id is the position of the vertex in the string table, and the edge lists are written as varints
+ * return False if the file could not be written
+ */
+bool graph_save (graph G, FILE *file);
+/**
+ * graph_is_snapshot
+ * return True if the size bytes at buf start like a snapshot written by graph_save
+ */
+bool graph_is_snapshot (const char *buf, size_t size);
+/**
+ * graph_read_snapshot
+ * build a graph from the size bytes of a snapshot at buf, which can be a read only mapping of the file
+ * return NULL if the snapshot is malformed or truncated
+ */
+graph graph_read_snapshot (const char *buf, size_t size);
 
 // vertex interface
 /**
@@ -52,6 +84,12 @@ void graph_show (graph G, FILE *file);
  * if a vertex with the same value already exists do not add a new vertex
  */
 void graph_add_vertex (graph G, string vertex);
+/**
+ * graph_add_vertex_bytes
+ * Add a new vertex whose value is the len bytes at vertex, which need not be null terminated
+ * if a vertex with the same value already exists do not add a new vertex
+ */
+void graph_add_vertex_bytes (graph G, const char *vertex, size_t len);
 /**
  * graph_has_vertex
  * return True if a vertex with a particular value exists in the graph, False otherwise
@@ -77,6 +115,24 @@ size_t graph_vertices_count (graph G);
  * if a edge between two vertices already exists do not add a new edge
  */
 void graph_add_edge (graph G, string vertex1, string vertex2, size_t weight);
+/**
+ * graph_add_edge_bytes
+ * Add a new edge like graph_add_edge, between vertices given as the len1 bytes at vertex1 and the len2 bytes at vertex2
+ * The values need not be null terminated, so they can point straight into a file buffer
+ */
+void graph_add_edge_bytes (graph G, const char *vertex1, size_t len1, const char *vertex2, size_t len2, size_t weight);
+/**
+ * graph_increment_edge
+ * Add one to the weight of the edge between two vertices, adding the vertices and an edge of weight 1 if they do not exist
+ */
+void graph_increment_edge (graph G, string vertex1, string vertex2);
+/**
+ * graph_increment_edge_ids
+ * Add one to the weight of the edge like graph_increment_edge, between vertices given by their ids in the graph's pool
+ * The pool's copy, length and hash of each value are reused, so the values are never measured, hashed or interned again
+ * Only for graphs made by graph_create_interned
+ */
+void graph_increment_edge_ids (graph G, size_t id1, size_t id2);
 /**
  * graph_has_edge
  * return True if a edge between two vertices exists in the graph, False otherwise
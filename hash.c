@@ -0,0 +1,25 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hash.h"
+
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+size_t hash_string (string value) {
+    uint64_t h = FNV_OFFSET;
+    while (*value) {
+        h ^= (unsigned char) *value++;
+        h *= FNV_PRIME;
+    }
+    return (size_t) h;
+}
+
+size_t hash_bytes (const char *value, size_t len) {
+    uint64_t h = FNV_OFFSET;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char) value[i];
+        h *= FNV_PRIME;
+    }
+    return (size_t) h;
+}
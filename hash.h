@@ -0,0 +1,24 @@
+#ifndef T_STRING
+#define T_STRING
+
+typedef char *string;
+
+#endif // T_STRING
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+
+/**
+ * hash_string
+ * return the FNV-1a hash of a null terminated string
+ */
+size_t hash_string (string);
+/**
+ * hash_bytes
+ * return the FNV-1a hash of the first len bytes of a buffer, equal to hash_string of the same characters
+ */
+size_t hash_bytes (const char *, size_t len);
+
+#endif // HASH_H
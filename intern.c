@@ -0,0 +1,147 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "intern.h"
+#include "hash.h"
+#include "arena.h"
+
+#define INTERN_INITIAL_SLOTS 64
+
+// define the structure of an interned url, its id is its position in the entries array
+typedef struct Entry {
+    string data;
+    size_t len;
+    size_t hash;
+} Entry;
+
+typedef struct Intern_Repr {
+    struct Arena arena; // where the urls are packed one after another
+    struct Entry *entries;
+    size_t n_entries;
+    size_t capacity;
+    unsigned char *marks; // one bit per entry
+    size_t *slots; // open addressing table of id + 1, 0 for an empty slot
+    size_t n_slots; // always a power of two, and at least twice the number of entries
+} Intern_Repr;
+
+// This function is to find the slot holding a url, or the empty slot where it would be inserted.
+size_t *intern_probe (intern_pool P, const char *url, size_t len, size_t hash) {
+    size_t i = hash & (P->n_slots - 1);
+    while (P->slots[i]) {
+        Entry *e = &P->entries[P->slots[i] - 1];
+        if (e->hash == hash && e->len == len && memcmp(e->data, url, len) == 0) break;
+        i = (i + 1) & (P->n_slots - 1);
+    }
+    return &P->slots[i];
+}
+
+// This function is to double the table, keeping the load factor at or below a half.
+bool intern_grow_slots (intern_pool P) {
+    size_t n_slots = P->n_slots * 2;
+    size_t *slots = calloc(n_slots, sizeof(*slots));
+    if (!slots) return false;
+    for (size_t id = 0; id < P->n_entries; id++) {
+        size_t j = P->entries[id].hash & (n_slots - 1);
+        while (slots[j]) {
+            j = (j + 1) & (n_slots - 1);
+        }
+        slots[j] = id + 1;
+    }
+    free(P->slots);
+    P->slots = slots;
+    P->n_slots = n_slots;
+    return true;
+}
+
+// This function is to double the entries array and the marks that go with it.
+bool intern_grow_entries (intern_pool P) {
+    size_t capacity = P->capacity * 2;
+    Entry *entries = realloc(P->entries, capacity * sizeof(*entries));
+    if (!entries) return false;
+    P->entries = entries;
+    unsigned char *marks = realloc(P->marks, capacity / 8);
+    if (!marks) return false;
+    memset(marks + P->capacity / 8, 0, (capacity - P->capacity) / 8);
+    P->marks = marks;
+    P->capacity = capacity;
+    return true;
+}
+
+intern_pool intern_create (void) {
+    intern_pool P = malloc(sizeof(*P));
+    if (!P) return NULL;
+    arena_init(&P->arena);
+    P->n_entries = 0;
+    P->capacity = INTERN_INITIAL_SLOTS / 2;
+    P->n_slots = INTERN_INITIAL_SLOTS;
+    P->entries = malloc(P->capacity * sizeof(*P->entries));
+    P->marks = calloc(P->capacity / 8, 1);
+    P->slots = calloc(P->n_slots, sizeof(*P->slots));
+    if (!P->entries || !P->marks || !P->slots) {
+        intern_destroy(P);
+        return NULL;
+    }
+    return P;
+}
+
+void intern_destroy (intern_pool P) {
+    if (!P) return;
+    arena_destroy(&P->arena);
+    free(P->entries);
+    free(P->marks);
+    free(P->slots);
+    free(P);
+}
+
+size_t intern_count (intern_pool P) {
+    if (!P) return 0;
+    return P->n_entries;
+}
+
+size_t intern_add (intern_pool P, const char *url, size_t len) {
+    if (!P) return INTERN_NONE;
+    // the table grows before probing, so the slot found stays valid and there is always an empty slot
+    if ((P->n_entries + 1) * 2 > P->n_slots && !intern_grow_slots(P)) return INTERN_NONE;
+    size_t hash = hash_bytes(url, len);
+    size_t *slot = intern_probe(P, url, len, hash);
+    if (*slot) return *slot - 1;
+    if (P->n_entries == P->capacity && !intern_grow_entries(P)) return INTERN_NONE;
+    string copy = arena_copy(&P->arena, url, len);
+    if (!copy) return INTERN_NONE;
+    size_t id = P->n_entries++;
+    P->entries[id] = (Entry) { copy, len, hash };
+    *slot = id + 1;
+    return id;
+}
+
+size_t intern_find (intern_pool P, const char *url, size_t len) {
+    if (!P) return INTERN_NONE;
+    size_t *slot = intern_probe(P, url, len, hash_bytes(url, len));
+    return *slot ? *slot - 1 : INTERN_NONE;
+}
+
+string intern_string (intern_pool P, size_t id) {
+    return P->entries[id].data;
+}
+
+size_t intern_length (intern_pool P, size_t id) {
+    return P->entries[id].len;
+}
+
+size_t intern_hash (intern_pool P, size_t id) {
+    return P->entries[id].hash;
+}
+
+bool intern_mark (intern_pool P, size_t id) {
+    unsigned char bit = 1 << (id % 8);
+    if (P->marks[id / 8] & bit) return false;
+    P->marks[id / 8] |= bit;
+    return true;
+}
+
+bool intern_marked (intern_pool P, size_t id) {
+    return (P->marks[id / 8] >> (id % 8)) & 1;
+}
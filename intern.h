@@ -0,0 +1,84 @@
+#ifndef T_STRING
+#define T_STRING
+
+typedef char *string;
+
+#endif // T_STRING
+
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// the id intern_find returns for a url that is not in the pool
+#define INTERN_NONE SIZE_MAX
+
+typedef struct Intern_Repr *intern_pool;
+
+// meta interface
+/**
+ * intern_create
+ * allocate the required memory for a new, empty pool of urls
+ * return NULL on error
+ */
+intern_pool intern_create (void);
+/**
+ * intern_destroy
+ * free all memory associated with a given pool, every string it handed out goes with it
+ */
+void intern_destroy (intern_pool);
+
+// misc interface
+/**
+ * intern_count
+ * return the number of distinct urls in the pool, which is also the next id it will hand out
+ * return 0 on error
+ */
+size_t intern_count (intern_pool);
+
+// pool interface
+/**
+ * intern_add
+ * add the len bytes at url to the pool, if they are not already in it, copying them once into the pool's arena
+ * ids are handed out from 0 in the order urls are first added, and never change
+ * return the id of the url
+ * return INTERN_NONE on error
+ */
+size_t intern_add (intern_pool, const char *url, size_t len);
+/**
+ * intern_find
+ * return the id of the len bytes at url
+ * return INTERN_NONE if they are not in the pool
+ */
+size_t intern_find (intern_pool, const char *url, size_t len);
+/**
+ * intern_string
+ * return the null terminated copy of the url with a particular id, which stays valid until the pool is destroyed
+ * two ids are the same url exactly when their strings are the same pointer
+ */
+string intern_string (intern_pool, size_t id);
+/**
+ * intern_length
+ * return the length of the url with a particular id
+ */
+size_t intern_length (intern_pool, size_t id);
+/**
+ * intern_hash
+ * return the hash_bytes hash of the url with a particular id, computed once when it was added
+ */
+size_t intern_hash (intern_pool, size_t id);
+/**
+ * intern_mark
+ * mark the url with a particular id, every url starts unmarked
+ * return True if the url was not marked before, so a pool can double as a visited set
+ */
+bool intern_mark (intern_pool, size_t id);
+/**
+ * intern_marked
+ * return True if the url with a particular id has been marked, without marking it
+ */
+bool intern_marked (intern_pool, size_t id);
+
+#endif // INTERN_H
@@ -0,0 +1,101 @@
+#include <limits.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libxml/HTMLparser.h>
+#include <libxml/xpath.h>
+
+#include "links.h"
+
+#define LINK_PARSE_OPTIONS (HTML_PARSE_NOBLANKS | HTML_PARSE_NOERROR | HTML_PARSE_NOWARNING | HTML_PARSE_NONET)
+
+typedef struct Link_Parser_Repr {
+    htmlParserCtxtPtr ctxt;
+    xmlSAXHandler sax;
+    link_found found;
+    void *ctx;
+} Link_Parser_Repr;
+
+// SAX start tag handler, the only event the streaming scan listens to
+void link_parser_start_element (void *user, const xmlChar *name, const xmlChar **attrs) {
+    link_parser P = user;
+    if (!attrs || strcmp((const char *) name, "a") != 0) return;
+    for (size_t i = 0; attrs[i]; i += 2) {
+        if (strcmp((const char *) attrs[i], "href") == 0 && attrs[i + 1]) {
+            P->found((string) attrs[i + 1], P->ctx);
+        }
+    }
+}
+
+void links_extract_xpath (const char *buf, size_t size, string url, link_found found, void *ctx) {
+    htmlDocPtr doc = htmlReadMemory(buf, (int) size, url, NULL, LINK_PARSE_OPTIONS);
+    if (!doc) return;
+
+    xmlChar *xpath = (xmlChar*) "//a/@href";
+    xmlXPathContextPtr context = xmlXPathNewContext(doc);
+    xmlXPathObjectPtr result = xmlXPathEvalExpression(xpath, context);
+    xmlXPathFreeContext(context);
+    if (!result) {
+        xmlFreeDoc(doc);
+        return;
+    }
+    xmlNodeSetPtr nodeset = result->nodesetval;
+    if (xmlXPathNodeSetIsEmpty(nodeset)) {
+        xmlXPathFreeObject(result);
+        xmlFreeDoc(doc);
+        return;
+    }
+
+    for (int i = 0; i < nodeset->nodeNr; i++) {
+        const xmlNode *node = nodeset->nodeTab[i]->xmlChildrenNode;
+        xmlChar *href = xmlNodeListGetString(doc, node, 1);
+        if (!href) continue;
+        found((string) href, ctx);
+        xmlFree(href);
+    }
+    xmlXPathFreeObject(result);
+    xmlFreeDoc(doc);
+}
+
+void links_extract_stream (const char *buf, size_t size, string url, link_found found, void *ctx) {
+    link_parser P = link_parser_create(url, found, ctx);
+    if (!P) return;
+    link_parser_feed(P, buf, size);
+    link_parser_finish(P);
+}
+
+link_parser link_parser_create (string url, link_found found, void *ctx) {
+    link_parser P = malloc(sizeof(*P));
+    if (!P) return NULL;
+    memset(&P->sax, 0, sizeof(P->sax));
+    P->sax.startElement = link_parser_start_element;
+    P->found = found;
+    P->ctx = ctx;
+    // start from the same utf-8 guess htmlReadMemory makes, a <meta> charset still switches it
+    P->ctxt = htmlCreatePushParserCtxt(&P->sax, P, NULL, 0, url, XML_CHAR_ENCODING_UTF8);
+    if (!P->ctxt) {
+        free(P);
+        return NULL;
+    }
+    htmlCtxtUseOptions(P->ctxt, LINK_PARSE_OPTIONS);
+    return P;
+}
+
+void link_parser_feed (link_parser P, const char *chunk, size_t size) {
+    if (!P) return;
+    // the parser takes an int length, so very large chunks are fed in pieces
+    while (size) {
+        int n = size > INT_MAX ? INT_MAX : (int) size;
+        htmlParseChunk(P->ctxt, chunk, n, 0);
+        chunk += n;
+        size -= n;
+    }
+}
+
+void link_parser_finish (link_parser P) {
+    if (!P) return;
+    htmlParseChunk(P->ctxt, NULL, 0, 1);
+    htmlFreeParserCtxt(P->ctxt);
+    free(P);
+}
@@ -0,0 +1,53 @@
+#ifndef T_STRING
+#define T_STRING
+
+typedef char *string;
+
+#endif // T_STRING
+
+#ifndef LINKS_H
+#define LINKS_H
+
+#include <stddef.h>
+
+/**
+ * link_found
+ * called once for the href of every <a> element, in document order
+ * href is only valid for the duration of the call
+ */
+typedef void (*link_found) (string href, void *ctx);
+
+typedef struct Link_Parser_Repr *link_parser;
+
+// whole document interface
+/**
+ * links_extract_xpath
+ * parse an html document into a tree and report the hrefs matched by //a/@href
+ */
+void links_extract_xpath (const char *buf, size_t size, string url, link_found found, void *ctx);
+/**
+ * links_extract_stream
+ * scan an html document with a SAX parser and report the hrefs as they are seen, without building a tree
+ * reports the same hrefs as links_extract_xpath
+ */
+void links_extract_stream (const char *buf, size_t size, string url, link_found found, void *ctx);
+
+// push interface
+/**
+ * link_parser_create
+ * start an incremental streaming scan of an html document
+ * return NULL on error
+ */
+link_parser link_parser_create (string url, link_found found, void *ctx);
+/**
+ * link_parser_feed
+ * scan the next chunk of the document, reporting any hrefs completed by it
+ */
+void link_parser_feed (link_parser, const char *chunk, size_t size);
+/**
+ * link_parser_finish
+ * scan the end of the document, reporting any remaining hrefs, and free the parser
+ */
+void link_parser_finish (link_parser);
+
+#endif // LINKS_H
@@ -4,6 +4,11 @@
 #include "graph.h"
 
 void graph_pagerank(graph G, double damping, double delta);
+// same ranks as graph_pagerank, within delta, computed by a fused kernel over a CSR snapshot of the graph
+// the vertices are split between n_threads threads, 1 runs it on the calling thread only
+void graph_pagerank_csr(graph G, double damping, double delta, size_t n_threads);
 void graph_viewrank(graph G, FILE *file);
+// print the first k lines graph_viewrank would, selecting them with a heap of k vertices instead of sorting them all
+void graph_viewrank_top(graph G, size_t k, FILE *file);
 
 #endif // PAGERANK_H
@@ -0,0 +1,214 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "politeness.h"
+#include "hash.h"
+
+#define HOSTS_INITIAL_BUCKETS 16
+
+// define the structure of a queued url, by its id in the scheduler's pool
+typedef struct Url_Node {
+    size_t id;
+    size_t seq; // global enqueue order, used to keep the frontier breadth first across hosts
+    struct Url_Node *next;
+} Url_Node;
+
+// define the structure of a host, with its own queue of urls
+typedef struct Host {
+    string name; // host[:port] part of the urls in this queue
+    size_t hash;
+    double next_allowed; // monotonic time in seconds before which the host must not be fetched from
+    size_t active_index; // position in the active array while the queue is not empty
+    struct Url_Node *head;
+    struct Url_Node *tail;
+    struct Host *hnext; // point to the next host in the same bucket
+} Host;
+
+typedef struct Scheduler_Repr {
+    struct Host **buckets; // hash index from host name to host
+    size_t n_buckets;
+    size_t n_hosts;
+    struct Host **active; // the hosts which have urls queued
+    size_t n_active;
+    size_t length; // the total number of queued urls
+    size_t seq;
+    double delay; // the politeness delay in seconds
+    intern_pool urls; // the pool the queued ids refer to
+} Scheduler_Repr;
+
+// ===========================================utility functions=========================================================
+
+double scheduler_now (void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// This function is to locate the host part of a url, skipping the scheme and stopping at the path.
+const char *scheduler_host_of (string url, size_t *len) {
+    const char *start = strstr(url, "://");
+    start = start ? start + 3 : url;
+    *len = strcspn(start, "/?#");
+    return start;
+}
+
+// This function is to double the buckets of the host index, return false and leave the index as it was on error.
+bool scheduler_grow (scheduler S) {
+    size_t n_buckets = S->n_buckets ? S->n_buckets * 2 : HOSTS_INITIAL_BUCKETS;
+    // the active array has room for every host, so it grows along with the buckets, and first, so a failure loses nothing
+    Host **active = realloc(S->active, n_buckets * sizeof(*active));
+    if (!active) return false;
+    S->active = active;
+    Host **buckets = calloc(n_buckets, sizeof(*buckets));
+    if (!buckets) return false;
+    for (size_t i = 0; i < S->n_buckets; i++) {
+        Host *h = S->buckets[i];
+        while (h) {
+            Host *next = h->hnext;
+            h->hnext = buckets[h->hash & (n_buckets - 1)];
+            buckets[h->hash & (n_buckets - 1)] = h;
+            h = next;
+        }
+    }
+    free(S->buckets);
+    S->buckets = buckets;
+    S->n_buckets = n_buckets;
+    return true;
+}
+
+// This function is to find the host of a url, adding it if it has not been seen before, NULL on error.
+Host *scheduler_host (scheduler S, string url) {
+    size_t len;
+    const char *name = scheduler_host_of(url, &len);
+    size_t hash = hash_bytes(name, len);
+    if (S->n_buckets) {
+        Host *h = S->buckets[hash & (S->n_buckets - 1)];
+        while (h) {
+            if (h->hash == hash && strncmp(h->name, name, len) == 0 && h->name[len] == '\0') {
+                return h;
+            }
+            h = h->hnext;
+        }
+    }
+    // a host more than the buckets would not fit in the active array, so a failed grow fails the host as well
+    if (S->n_hosts >= S->n_buckets && !scheduler_grow(S)) return NULL;
+    Host *new = malloc(sizeof(*new));
+    if (!new) return NULL;
+    new->name = strndup(name, len);
+    if (!new->name) {
+        free(new);
+        return NULL;
+    }
+    new->hash = hash;
+    new->next_allowed = 0;
+    new->active_index = 0;
+    new->head = new->tail = NULL;
+    new->hnext = S->buckets[hash & (S->n_buckets - 1)];
+    S->buckets[hash & (S->n_buckets - 1)] = new;
+    S->n_hosts++;
+    return new;
+}
+//======================================================================================================================
+
+scheduler scheduler_create (long delay_ms, intern_pool urls) {
+    scheduler S = malloc(sizeof(*S));
+    if (!S) return NULL;
+    S->buckets = NULL;
+    S->n_buckets = S->n_hosts = 0;
+    S->active = NULL;
+    S->n_active = 0;
+    S->length = S->seq = 0;
+    S->delay = delay_ms / 1e3;
+    S->urls = urls;
+    return S;
+}
+
+void scheduler_destroy (scheduler S) {
+    if (!S) return;
+    for (size_t i = 0; i < S->n_buckets; i++) {
+        Host *h = S->buckets[i];
+        while (h) {
+            Host *next = h->hnext;
+            Url_Node *u = h->head;
+            while (u) {
+                Url_Node *temp = u;
+                u = u->next;
+                free(temp);
+            }
+            free(h->name);
+            free(h);
+            h = next;
+        }
+    }
+    free(S->buckets);
+    free(S->active);
+    free(S);
+}
+
+bool scheduler_is_empty (scheduler S) {
+    return S->length == 0;
+}
+
+size_t scheduler_length (scheduler S) {
+    return S->length;
+}
+
+bool scheduler_enqueue (scheduler S, size_t id) {
+    Host *h = scheduler_host(S, intern_string(S->urls, id));
+    if (!h) return false;
+    Url_Node *new = malloc(sizeof(*new));
+    if (!new) return false;
+    new->id = id;
+    new->seq = S->seq++;
+    new->next = NULL;
+    if (!h->head) {
+        h->head = h->tail = new;
+        h->active_index = S->n_active;
+        S->active[S->n_active++] = h;
+    } else {
+        h->tail->next = new;
+        h->tail = new;
+    }
+    S->length++;
+    return true;
+}
+
+size_t scheduler_dequeue (scheduler S) {
+    double now = scheduler_now();
+    Host *best = NULL;
+    // among the hosts that are ready, take the one whose next url was queued first
+    for (size_t i = 0; i < S->n_active; i++) {
+        Host *h = S->active[i];
+        if (h->next_allowed <= now && (!best || h->head->seq < best->head->seq)) {
+            best = h;
+        }
+    }
+    if (!best) return INTERN_NONE;
+
+    Url_Node *u = best->head;
+    best->head = u->next;
+    if (!best->head) {
+        best->tail = NULL;
+        S->active[best->active_index] = S->active[--S->n_active];
+        S->active[best->active_index]->active_index = best->active_index;
+    }
+    best->next_allowed = now + S->delay;
+    S->length--;
+    size_t id = u->id;
+    free(u);
+    return id;
+}
+
+long scheduler_wait_ms (scheduler S) {
+    if (!S->n_active) return -1;
+    double now = scheduler_now();
+    double soonest = S->active[0]->next_allowed;
+    for (size_t i = 1; i < S->n_active; i++) {
+        if (S->active[i]->next_allowed < soonest) soonest = S->active[i]->next_allowed;
+    }
+    if (soonest <= now) return 0;
+    return (long) ((soonest - now) * 1e3) + 1;
+}
@@ -0,0 +1,67 @@
+#ifndef T_STRING
+#define T_STRING
+
+typedef char *string;
+
+#endif // T_STRING
+
+#ifndef POLITENESS_H
+#define POLITENESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "intern.h"
+
+typedef struct Scheduler_Repr *scheduler;
+
+// meta interface
+/**
+ * scheduler_create
+ * allocate the required memory for a new crawl frontier
+ * consecutive fetches from the same host are spaced at least delay_ms milliseconds apart
+ * urls are queued by their id in the given pool, which must outlive the scheduler
+ * return NULL on error
+ */
+scheduler scheduler_create (long delay_ms, intern_pool urls);
+/**
+ * scheduler_destroy
+ * free all memory associated with a given scheduler, the pool and its urls are left alone
+ */
+void scheduler_destroy (scheduler);
+
+// misc interface
+/**
+ * scheduler_is_empty
+ * return True if there are no queued urls, False otherwise
+ */
+bool scheduler_is_empty (scheduler);
+/**
+ * scheduler_length
+ * return the number of queued urls
+ */
+size_t scheduler_length (scheduler);
+
+// queue interface
+/**
+ * scheduler_enqueue
+ * add the url with a particular id in the pool to the back of its host's queue
+ * return False on error, leaving the url unqueued
+ */
+bool scheduler_enqueue (scheduler, size_t id);
+/**
+ * scheduler_dequeue
+ * remove and return the oldest queued url among the hosts that may be fetched from now,
+ * and hold back its host for the politeness delay
+ * return the id of the url in the pool
+ * return INTERN_NONE if no host is ready
+ */
+size_t scheduler_dequeue (scheduler);
+/**
+ * scheduler_wait_ms
+ * return the number of milliseconds until scheduler_dequeue can return a url
+ * return -1 if the scheduler is empty
+ */
+long scheduler_wait_ms (scheduler);
+
+#endif // POLITENESS_H
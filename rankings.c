@@ -9,17 +9,70 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <getopt.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 #include "graph.h"
 #include "pagerank.h"
-
-graph read_cache            (string);
+#include "cache.h"
 
 int main(int argc, char **argv)
 {
     double damping_factor = .85;
     double epsilon = 0.00001;
+    string engine = NULL;
+    long threads = 1;
+    long top = 0;
+    string program = argv[0];
+
+    struct option options[] = {
+        {"engine", required_argument, NULL, 'e'},
+        {"threads", required_argument, NULL, 't'},
+        {"top", required_argument, NULL, 'k'},
+        {NULL, 0, NULL, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "e:t:k:", options, NULL)) != -1) {
+        switch (opt) {
+            case 'e': {
+                if (strcmp(optarg, "list") != 0 && strcmp(optarg, "csr") != 0) {
+                    fprintf(stderr, "'%s' is not a PageRank engine (list or csr)\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                engine = optarg;
+                break;
+            }
+            case 't': {
+                char *endptr = NULL;
+                threads = strtol(optarg, &endptr, 10);
+                if (*endptr != '\0' || threads < 1) {
+                    fprintf(stderr, "'%s' is not a positive integer\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+            case 'k': {
+                char *endptr = NULL;
+                top = strtol(optarg, &endptr, 10);
+                if (*endptr != '\0' || top < 1) {
+                    fprintf(stderr, "'%s' is not a positive integer\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+            default: {
+                fprintf(stderr, "Usage: %s [-e <list | csr>] [-t <threads>] [-k <top>] <url> [<damping factor>] [<epsilon>]\n", program);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    // the threads load the cache and, as only the csr engine can be split between them, select it unless told otherwise
+    bool use_csr = engine ? strcmp(engine, "csr") == 0 : threads > 1;
+
+    // the remaining positional arguments are read as if they started at argv[1]
+    argc -= optind - 1;
+    argv += optind - 1;
 
     switch (argc) {
         case 4: {
@@ -44,75 +97,27 @@ int main(int argc, char **argv)
             break;
         }
         default: {
-            fprintf(stderr, "Usage: %s <url> [<damping factor>] [<epsilon>]\n", argv[0]);
+            fprintf(stderr, "Usage: %s [-e <list | csr>] [-t <threads>] [-k <top>] <url> [<damping factor>] [<epsilon>]\n", program);
             return EXIT_FAILURE;
         }
     }
 
-    graph network = read_cache(argv[1]);
+    graph network = cache_load(argv[1], threads);
+    if (!network) return EXIT_FAILURE;
     printf("Graph vertices and edges:\n");
     graph_show(network, stdout);
     printf("\nGraph PageRank:\n");
-    graph_pagerank(network, damping_factor, epsilon);
-    graph_viewrank(network, stdout);
+    if (use_csr) {
+        graph_pagerank_csr(network, damping_factor, epsilon, threads);
+    } else {
+        graph_pagerank(network, damping_factor, epsilon);
+    }
+    if (top) {
+        graph_viewrank_top(network, top, stdout);
+    } else {
+        graph_viewrank(network, stdout);
+    }
     graph_destroy (network);
 
     return EXIT_SUCCESS;
 }
-
-graph read_cache(string url)
-{
-    if (access(url, R_OK) != 0) return NULL;
-    FILE *cache = fopen(url, "r");
-    if (!cache) return NULL;
-
-    graph network = graph_create();
-    if (!network) return NULL;
-
-    char input_buffer[BUFSIZ];
-    while (fgets(input_buffer, BUFSIZ, cache)) {
-        if (!strchr(input_buffer, '\n')) {
-            fprintf(stderr, "Line to Long: aborting reading cache file.\n");
-            return NULL;
-        }
-        // split the line into an array of tokens
-        size_t  n_tok = 1;
-        char **toks = malloc(n_tok * sizeof(*toks));
-        toks[n_tok - 1] = strtok(input_buffer, " \t\n");
-        char *t = NULL;
-        while ((t = strtok(NULL, " \t\n"))) {
-            n_tok++;
-            toks = realloc(toks, n_tok * sizeof(*toks));
-            toks[n_tok - 1] = t;
-        }
-        switch (n_tok) {
-            case 1: {
-                graph_add_vertex(network, toks[0]);
-                break;
-            }
-            case 3: {
-                char *endptr = NULL;
-                size_t weight =  strtol(toks[2], &endptr, 10);
-                if (*endptr != '\0') {
-                    fprintf(stderr, "weight is not numeric.\n");
-                    free(toks);
-                    graph_destroy(network);
-                    return NULL;
-                } else {
-                    graph_add_edge(network, toks[0], toks[1], weight);
-                }
-                break;
-            }
-            default: {
-                fprintf(stderr, "Line has incorrect number of tokens.\n");
-                free(toks);
-                graph_destroy(network);
-                return NULL;
-            }
-        }
-        free(toks);
-    }
-
-    fclose(cache);
-    return network;
-}
@@ -0,0 +1,83 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "writer.h"
+
+#define WRITER_BUFFER_SIZE (1024 * 1024)
+// the digits of the largest 64 bit number
+#define WRITER_SIZE_DIGITS 20
+
+typedef struct Writer_Repr {
+    FILE *file;
+    char *buf;
+    size_t used;
+    bool failed; // a write to the file has failed, everything after it is dropped
+} Writer_Repr;
+
+writer writer_create (FILE *file) {
+    writer w = malloc(sizeof(*w));
+    if (!w) return NULL;
+    w->buf = malloc(WRITER_BUFFER_SIZE);
+    if (!w->buf) {
+        free(w);
+        return NULL;
+    }
+    w->file = file;
+    w->used = 0;
+    w->failed = false;
+    return w;
+}
+
+bool writer_destroy (writer w) {
+    if (!w) return false;
+    bool ok = writer_flush(w);
+    free(w->buf);
+    free(w);
+    return ok;
+}
+
+bool writer_flush (writer w) {
+    if (w->used && !w->failed) {
+        w->failed = fwrite(w->buf, 1, w->used, w->file) != w->used;
+    }
+    w->used = 0;
+    return !w->failed;
+}
+
+void writer_bytes (writer w, const char *bytes, size_t len) {
+    if (w->used + len > WRITER_BUFFER_SIZE) {
+        writer_flush(w);
+        // anything that cannot fit in the buffer on its own goes straight to the file
+        if (len > WRITER_BUFFER_SIZE) {
+            if (!w->failed) {
+                w->failed = fwrite(bytes, 1, len, w->file) != len;
+            }
+            return;
+        }
+    }
+    memcpy(w->buf + w->used, bytes, len);
+    w->used += len;
+}
+
+void writer_string (writer w, string value) {
+    writer_bytes(w, value, strlen(value));
+}
+
+void writer_char (writer w, char c) {
+    if (w->used == WRITER_BUFFER_SIZE) writer_flush(w);
+    w->buf[w->used++] = c;
+}
+
+void writer_size (writer w, size_t value) {
+    // the digits come out least significant first, so they are written from the end of a scratch buffer
+    char digits[WRITER_SIZE_DIGITS];
+    size_t i = WRITER_SIZE_DIGITS;
+    do {
+        digits[--i] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    writer_bytes(w, digits + i, WRITER_SIZE_DIGITS - i);
+}
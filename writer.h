@@ -0,0 +1,59 @@
+#ifndef T_STRING
+#define T_STRING
+
+typedef char *string;
+
+#endif // T_STRING
+
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+typedef struct Writer_Repr *writer;
+
+// meta interface
+/**
+ * writer_create
+ * allocate a large output buffer in front of the given file, which must stay open until the writer is destroyed
+ * return NULL on error
+ */
+writer writer_create (FILE *file);
+/**
+ * writer_destroy
+ * flush anything still buffered and free the writer, the file is left open
+ * return False if any write to the file failed
+ */
+bool writer_destroy (writer);
+
+// output interface
+/**
+ * writer_bytes
+ * append the first len bytes of a buffer
+ */
+void writer_bytes (writer, const char *, size_t len);
+/**
+ * writer_string
+ * append a null terminated string
+ */
+void writer_string (writer, string);
+/**
+ * writer_char
+ * append a single character
+ */
+void writer_char (writer, char);
+/**
+ * writer_size
+ * append a number in decimal, the same digits as printf's %zu
+ */
+void writer_size (writer, size_t);
+/**
+ * writer_flush
+ * hand everything buffered to the file
+ * return False if any write to the file failed
+ */
+bool writer_flush (writer);
+
+#endif // WRITER_H